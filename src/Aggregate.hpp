@@ -0,0 +1,101 @@
+#ifndef     _AGGREGATE_HPP_
+# define    _AGGREGATE_HPP_
+
+# include <algorithm>
+# include <cstddef>
+# include <limits>
+# if defined(__AVX__)
+#  include <immintrin.h>
+# elif defined(__SSE2__)
+#  include <emmintrin.h>
+# endif
+
+/**
+ * COUNT / SUM / MIN / MAX (and AVG) of a run of values.
+ *
+ * Partial aggregates of separate runs combine with merge(), so a column
+ * can be split across threads and the pieces folded together afterwards.
+ */
+struct Aggregate
+{
+    std::size_t count = 0;
+    double sum = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    double average() const
+    {
+        return count == 0 ? 0.0 : sum / count;
+    }
+
+    void merge(const Aggregate &other)
+    {
+        count += other.count;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+};
+
+/**
+ * Aggregate a contiguous column slice.
+ *
+ * Vectorised with AVX when the compiler targets it (ex -march=native),
+ * SSE2 on any other x86-64 build, plain scalar code elsewhere. Two
+ * independent accumulators per lane hide the add latency; the tail that
+ * does not fill a vector is done in scalar code.
+ */
+inline Aggregate aggregateRange(const double *values, std::size_t count)
+{
+    Aggregate result;
+    std::size_t i = 0;
+#if defined(__AVX__)
+    __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+    __m256d low = _mm256_set1_pd(result.min), high = _mm256_set1_pd(result.max);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256d a = _mm256_loadu_pd(values + i);
+        __m256d b = _mm256_loadu_pd(values + i + 4);
+        sum0 = _mm256_add_pd(sum0, a);
+        sum1 = _mm256_add_pd(sum1, b);
+        low = _mm256_min_pd(low, _mm256_min_pd(a, b));
+        high = _mm256_max_pd(high, _mm256_max_pd(a, b));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(sum0, sum1));
+    result.sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm256_store_pd(lanes, low);
+    result.min = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+    _mm256_store_pd(lanes, high);
+    result.max = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(__SSE2__)
+    __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+    __m128d low = _mm_set1_pd(result.min), high = _mm_set1_pd(result.max);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128d a = _mm_loadu_pd(values + i);
+        __m128d b = _mm_loadu_pd(values + i + 2);
+        sum0 = _mm_add_pd(sum0, a);
+        sum1 = _mm_add_pd(sum1, b);
+        low = _mm_min_pd(low, _mm_min_pd(a, b));
+        high = _mm_max_pd(high, _mm_max_pd(a, b));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(sum0, sum1));
+    result.sum = lanes[0] + lanes[1];
+    _mm_store_pd(lanes, low);
+    result.min = std::min(lanes[0], lanes[1]);
+    _mm_store_pd(lanes, high);
+    result.max = std::max(lanes[0], lanes[1]);
+#endif
+    for (; i < count; ++i)
+    {
+        result.sum += values[i];
+        result.min = std::min(result.min, values[i]);
+        result.max = std::max(result.max, values[i]);
+    }
+    result.count = count;
+    return result;
+}
+
+#endif /*!_AGGREGATE_HPP_*/
@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
@@ -5,115 +10,303 @@
 
 namespace csv {
 
+  namespace {
+    // rows the tokenizer hands over per batch
+    const size_t BATCH_ROWS = 1024;
+
+    // blocks in flight between the stages
+    const size_t CHUNK_DEPTH = 4;
+    const size_t BATCH_DEPTH = 16;
+
+    // target rows per chunk of a RowStore's order (a chunk splits at twice that)
+    const size_t CHUNK_ROWS = 1024;
+
+    // rows a lazy RowStore keeps tokenized
+    const size_t LAZY_CACHE_ROWS = 256;
+
+    const size_t NONE = static_cast<size_t>(-1);
+
+    /*
+    ** The sidecar index of an eINDEXED parser, file.idx: this header, then
+    ** where every record starts and the end of the file, as uint64_t. It
+    ** only holds for the file it was built from (same inode, size,
+    ** modification and change times, and first and last bytes) read with
+    ** the same record rules.
+    */
+    struct IndexHeader
+    {
+        uint64_t magic;
+        uint64_t size;
+        uint64_t modified;    // nanoseconds
+        uint64_t changed;
+        uint64_t inode;
+        uint64_t sample;      // hash of the first and last INDEX_SAMPLE bytes
+        uint64_t dialect;     // the dialect settings that decide where records start
+        uint64_t headerStart;
+        uint64_t contentStart;
+        uint64_t records;
+
+        bool sameFile(const IndexHeader &other) const
+        {
+          return magic == other.magic && size == other.size && modified == other.modified
+                 && changed == other.changed && inode == other.inode
+                 && sample == other.sample && dialect == other.dialect;
+        }
+    };
+
+    const uint64_t INDEX_MAGIC = 0x3258444956534321ull; // "!CSVIDX2"
+    const size_t INDEX_SAMPLE = 64 * 1024;
+
+    std::string indexPath(const std::string &file)
+    {
+      return file + ".idx";
+    }
+
+    // fnv-1a
+    uint64_t hashBytes(const char *data, size_t length, uint64_t hash)
+    {
+      for (size_t i = 0; i < length; i++)
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ull;
+      return hash;
+    }
+
+    IndexHeader indexKey(const FileReader &file, const Dialect &dialect)
+    {
+      IndexHeader key = {};
+      key.magic = INDEX_MAGIC;
+      key.size = file.fileSize();
+      key.modified = static_cast<uint64_t>(file.modified());
+      key.changed = static_cast<uint64_t>(file.changed());
+      key.inode = file.inode();
+
+      std::string sample(std::min(INDEX_SAMPLE, file.fileSize()), '\0');
+      key.sample = 0xcbf29ce484222325ull;
+      key.sample = hashBytes(sample.data(), file.readAt(&sample[0], sample.size(), 0), key.sample);
+      size_t tail = file.fileSize() - sample.size();
+      key.sample = hashBytes(sample.data(), file.readAt(&sample[0], sample.size(), tail), key.sample);
+
+      key.dialect = static_cast<unsigned char>(dialect.separator)
+                    | static_cast<uint64_t>(static_cast<unsigned char>(dialect.quote)) << 8
+                    | static_cast<uint64_t>(static_cast<unsigned char>(dialect.escape)) << 16
+                    | static_cast<uint64_t>(static_cast<unsigned char>(dialect.comment)) << 24
+                    | static_cast<uint64_t>(dialect.crlf) << 32;
+      return key;
+    }
+
+    // small reads only: random access does not need big blocks
+    std::unique_ptr<FileReader> openForReads(const std::string &file)
+    {
+      return std::make_unique<FileReader>(file, 4096, 1, false);
+    }
+
+    // whether field reads back as itself unquoted: no separator, quote,
+    // escape or line break, no leading comment character, and no blanks
+    // at either end that trimming would drop
+    bool isPlainField(std::string_view field, const Dialect &dialect)
+    {
+      const char special[] = {dialect.separator, dialect.quote, dialect.escape, '\r', '\n'};
+      if (field.find_first_of(std::string_view(special, sizeof(special))) != std::string_view::npos)
+        return false;
+      if (dialect.comment != '\0' && !field.empty() && field.front() == dialect.comment)
+        return false;
+      return !dialect.trim || field.empty()
+             || (!detail::isBlank(dialect, field.front()) && !detail::isBlank(dialect, field.back()));
+    }
+
+    // write a field back in dialect, quoted with its quotes escaped
+    // unless it reads back the same without
+    void writeField(std::ostream &os, std::string_view field, const Dialect &dialect)
+    {
+      if (isPlainField(field, dialect))
+      {
+        os << field;
+        return;
+      }
+      const char escaped[] = {dialect.quote, dialect.escape};
+      os << dialect.quote;
+      for (size_t at; (at = field.find_first_of(std::string_view(escaped, sizeof(escaped)))) != std::string_view::npos;
+           field.remove_prefix(at + 1))
+        os << field.substr(0, at) << dialect.escape << field[at];
+      os << field << dialect.quote;
+    }
+
+    // write the fields of one record in dialect, without its line end
+    template <typename Field>
+    void writeFields(std::ostream &os, size_t fields, Field field, const Dialect &dialect)
+    {
+      // a lone empty field would be a blank line, which is skipped on reload
+      if (fields == 1 && field(0).empty())
+      {
+        os << dialect.quote << dialect.quote;
+        return;
+      }
+      for (size_t i = 0; i < fields; i++)
+      {
+        if (i)
+          os << dialect.separator;
+        writeField(os, field(i), dialect);
+      }
+    }
+
+    // write one record in dialect, with its line end
+    template <typename Field>
+    void writeRecord(std::ostream &os, size_t fields, Field field, const Dialect &dialect)
+    {
+      writeFields(os, fields, field, dialect);
+      os << (dialect.crlf ? "\r\n" : "\n");
+    }
+  }
+
   Parser::Parser(const std::string &data, const DataType &type, char sep)
-    : _type(type), _sep(sep)
+    : Parser(data, type, Dialect{sep})
   {
-      std::string line;
+  }
+
+  Parser::Parser(const std::string &data, const DataType &type, const Dialect &dialect, LoadMode mode)
+    : _type(type), _dialect(dialect), _mode(mode), _compression(eNONE), _rows(std::make_unique<RowStore>())
+  {
+      std::string &buffer = _rows->buffer;
+      _rows->dialect = dialect;
+      bool indexable = false;
       if (type == eFILE)
       {
         _file = data;
-        std::ifstream ifile(_file.c_str());
-        if (ifile.is_open())
-        {
-            while (ifile.good())
-            {
-                getline(ifile, line);
-                if (line != "")
-                    _originalFile.push_back(line);
-            }
-            ifile.close();
-
-            if (_originalFile.size() == 0)
-              throw Error(std::string("No Data in ").append(_file));
-            
-            parseHeader();
-            parseContent();
-        }
-        else
-            throw Error(std::string("Failed to open ").append(_file));
+        // a pipe can neither be read twice nor seeked in, so it is never indexed
+        std::error_code error;
+        indexable = mode == eINDEXED && std::filesystem::is_regular_file(_file, error);
+        if (indexable && loadIndex())
+          return;
+
+        // large block reads (several in flight with io_uring), decompressed
+        // on the fly when the file is gzip or zstd; the text is kept whole
+        // and the rows point into it
+        BlockReader reader(_file);
+        const char *block;
+        size_t length;
+        while (reader.next(block, length))
+            buffer.append(block, length);
+        // offsets into a compressed file cannot be seeked to
+        _compression = reader.compression();
+        indexable = indexable && _compression == eNONE;
       }
       else
+        buffer = data;
+
+      // the header is the first record that is neither blank nor a comment
+      size_t start = 0;
+      while (start < buffer.size())
       {
-        std::istringstream stream(data);
-        while (std::getline(stream, line))
-          if (line != "")
-            _originalFile.push_back(line);
-        if (_originalFile.size() == 0)
-          throw Error(std::string("No Data in pure content"));
-
-        parseHeader();
-        parseContent();
+        size_t end = _rows->recordEnd(start);
+        std::string_view record(buffer.data() + start, end - start);
+        if (acceptRecord(record, _dialect))
+        {
+          parseHeader(record);
+          parseContent(end + 1);
+          if (indexable)
+            saveIndex(start, end + 1);
+          return;
+        }
+        start = end + 1;
       }
+      if (type == eFILE)
+        throw Error(std::string("No Data in ").append(_file));
+      throw Error(std::string("No Data in pure content"));
   }
 
   Parser::~Parser(void)
   {
-     std::vector<Row *>::iterator it;
-
-     for (it = _content.begin(); it != _content.end(); it++)
-          delete *it;
   }
 
-  void Parser::parseHeader(void)
+  void Parser::parseHeader(std::string_view line)
   {
-      std::stringstream ss(_originalFile[0]);
-      std::string item;
+      std::string scratch;
+      splitFields(line, _dialect, scratch, [this](std::string_view name) { _header.emplace_back(name); });
+      _rows->columns = _header.size();
+      _rows->index = ColumnIndex(_header);
+  }
 
-      while (std::getline(ss, item, _sep))
-          _header.push_back(item);
+  void Parser::parseContent(size_t start)
+  {
+      if (_mode == eEAGER)
+        _rows->parse(start);
+      else
+        _rows->scan(start);
   }
 
-  void Parser::parseContent(void)
+  // open from file.idx when it still matches the file: only the header is read
+  bool Parser::loadIndex(void)
   {
-     std::vector<std::string>::iterator it;
-     
-     it = _originalFile.begin();
-     it++; // skip header
+      std::unique_ptr<FileReader> file = openForReads(_file);
+      std::ifstream in(indexPath(_file), std::ios::binary);
+      IndexHeader header;
+      if (!in.read(reinterpret_cast<char *>(&header), sizeof(header))
+          || !header.sameFile(indexKey(*file, _dialect))
+          || header.headerStart >= header.contentStart || header.contentStart > header.size
+          || header.records > header.size)
+        return false;
 
-     for (; it != _originalFile.end(); it++)
-     {
-         bool quoted = false;
-         int tokenStart = 0;
-         unsigned int i = 0;
+      std::vector<uint64_t> stored(header.records + 1);
+      if (!in.read(reinterpret_cast<char *>(stored.data()), stored.size() * sizeof(uint64_t))
+          || stored.back() != header.size)
+        return false;
 
-         Row *row = new Row(_header);
+      std::string text(header.contentStart - header.headerStart, '\0');
+      text.resize(file->readAt(&text[0], text.size(), header.headerStart));
+      RecordState state;
+      const char *newline = findRecordEnd(text.data(), text.size(), state, _dialect);
+      std::string_view record(text.data(), newline ? newline - text.data() : text.size());
+      if (!acceptRecord(record, _dialect))
+        return false;
+      parseHeader(record);
 
-         for (; i != it->length(); i++)
-         {
-              if (it->at(i) == '"')
-                  quoted = ((quoted) ? (false) : (true));
-              else if (it->at(i) == ',' && !quoted)
-              {
-                  row->push(it->substr(tokenStart, i - tokenStart));
-                  tokenStart = i + 1;
-              }
-         }
+      _rows->open(std::move(file), _file, std::vector<size_t>(stored.begin(), stored.end()),
+                  header.contentStart);
+      return true;
+  }
 
-         //end
-         row->push(it->substr(tokenStart, it->length() - tokenStart));
+  // write file.idx next to the file; an index that cannot be written is
+  // only a missed speedup, so failures are ignored
+  void Parser::saveIndex(size_t headerStart, size_t contentStart) const
+  {
+      IndexHeader header = indexKey(*openForReads(_file), _dialect);
+      header.headerStart = headerStart;
+      header.contentStart = contentStart;
+      header.records = _rows->records().size() - 1;
+      std::vector<uint64_t> stored(_rows->records().begin(), _rows->records().end());
 
-         // if value(s) missing
-         if (row->size() != _header.size())
-          throw Error("corrupted data !");
-         _content.push_back(row);
-     }
+      std::string path = indexPath(_file);
+      std::string partial = path + ".tmp";
+      {
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(stored.data()), stored.size() * sizeof(uint64_t));
+        if (!out.good())
+        {
+          out.close();
+          std::remove(partial.c_str());
+          return;
+        }
+      }
+      std::rename(partial.c_str(), path.c_str());
   }
 
-  Row &Parser::getRow(unsigned int rowPosition) const
+  Row Parser::getRow(unsigned int rowPosition) const
   {
-      if (rowPosition < _content.size())
-          return *(_content[rowPosition]);
+      // a lazy row keeps its record number, to fetch it again once evicted
+      if (rowPosition < _rows->rows())
+          return Row(_rows.get(), _rows->physical(rowPosition),
+                     _rows->lazy() ? rowPosition : Row::NO_RECORD);
       throw Error("can't return this row (doesn't exist)");
   }
 
-  Row &Parser::operator[](unsigned int rowPosition) const
+  Row Parser::operator[](unsigned int rowPosition) const
   {
       return Parser::getRow(rowPosition);
   }
 
   unsigned int Parser::rowCount(void) const
   {
-      return _content.size();
+      return _rows->rows();
   }
 
   unsigned int Parser::columnCount(void) const
@@ -121,12 +314,12 @@ namespace csv {
       return _header.size();
   }
 
-  std::vector<std::string> Parser::getHeader(void) const
+  const std::vector<std::string> &Parser::getHeader(void) const
   {
       return _header;
   }
 
-  const std::string Parser::getHeaderElement(unsigned int pos) const
+  const std::string &Parser::getHeaderElement(unsigned int pos) const
   {
       if (pos >= _header.size())
         throw Error("can't return this header (doesn't exist)");
@@ -135,10 +328,9 @@ namespace csv {
 
   bool Parser::deleteRow(unsigned int pos)
   {
-    if (pos < _content.size())
+    if (pos < _rows->rows())
     {
-      delete *(_content.begin() + pos);
-      _content.erase(_content.begin() + pos);
+      _rows->eraseRow(pos);
       return true;
     }
     return false;
@@ -146,40 +338,30 @@ namespace csv {
 
   bool Parser::addRow(unsigned int pos, const std::vector<std::string> &r)
   {
-    Row *row = new Row(_header);
+    if (pos > _rows->rows() || r.size() != _rows->columns)
+      return false;
 
-    for (auto it = r.begin(); it != r.end(); it++)
-      row->push(*it);
-    
-    if (pos <= _content.size())
-    {
-      _content.insert(_content.begin() + pos, row);
-      return true;
-    }
-    return false;
+    _rows->insertRow(pos, std::vector<std::string_view>(r.begin(), r.end()));
+    return true;
   }
 
   void Parser::sync(void) const
   {
     if (_type == DataType::eFILE)
     {
+      // plain CSV written over a .gz or .zst would no longer open as one
+      if (_compression != eNONE)
+        throw Error(std::string("Cannot sync compressed ").append(_file));
+      _rows->materialize();
+      if (_mode == eINDEXED)
+        std::remove(indexPath(_file).c_str()); // it is about to describe another file
       std::ofstream f;
       f.open(_file, std::ios::out | std::ios::trunc);
 
-      // header
-      unsigned int i = 0;
-      for (auto it = _header.begin(); it != _header.end(); it++)
-      {
-        f << *it;
-        if (i < _header.size() - 1)
-          f << ",";
-        else
-          f << std::endl;
-        i++;
-      }
-     
-      for (auto it = _content.begin(); it != _content.end(); it++)
-        f << **it << std::endl;
+      writeRecord(f, _header.size(), [this](size_t i) { return std::string_view(_header[i]); }, _dialect);
+      _rows->forEachRow([&](size_t physical) {
+          writeRecord(f, _rows->columns, [&](size_t i) { return _rows->field(physical, i); }, _dialect);
+      });
       f.close();
     }
   }
@@ -188,81 +370,671 @@ namespace csv {
   {
       return _file;    
   }
-  
+
+  ColumnHandle Parser::column(const std::string &name) const
+  {
+      return _rows->index.handle(name);
+  }
+
   /*
-  ** ROW
+  ** ROW STORE
   */
 
-  Row::Row(const std::vector<std::string> &header)
-      : _header(header) {}
+  size_t RowStore::recordEnd(size_t start) const
+  {
+      RecordState state;
+      const char *newline = findRecordEnd(buffer.data() + start, buffer.size() - start, state, dialect);
+      return newline ? newline - buffer.data() : buffer.size();
+  }
+
+  void RowStore::parse(size_t start)
+  {
+     offsets.clear();
 
-  Row::~Row(void) {}
+     // one loop per dialect, specialized on it
+     detail::withTraits(dialect, [&](const auto &traits) {
+       while (start < buffer.size())
+       {
+           size_t end = recordEnd(start);
+           std::string_view record(buffer.data() + start, end - start);
+           if (acceptRecord(record, dialect))
+           {
+               // fields are unescaped in place, packed from the start of the record
+               size_t fields = 0;
+               size_t fieldEnd = start;
+               splitFieldsInPlace(traits, &buffer[start], record.size(), [&](std::string_view value) {
+                   offsets.push_back(value.data() - buffer.data());
+                   fieldEnd = offsets.back() + value.size();
+                   fields++;
+               });
 
-  unsigned int Row::size(void) const
+               // if value(s) missing
+               if (fields != columns)
+                 throw Error("corrupted data !");
+               offsets.push_back(fieldEnd + 1);
+           }
+           start = end + 1;
+       }
+     });
+     reset();
+  }
+
+  void RowStore::scan(size_t start)
   {
-    return _values.size();
+      _lazy = true;
+      _contentStart = start;
+      _records.clear();
+      while (start < buffer.size())
+      {
+        size_t end = recordEnd(start);
+        std::string_view record(buffer.data() + start, end - start);
+        if (acceptRecord(record, dialect))
+          _records.push_back(start);
+        start = end + 1;
+      }
+      _records.push_back(buffer.size());
+      clearCache();
   }
 
-  void Row::push(const std::string &value)
+  void RowStore::open(std::unique_ptr<FileReader> file, const std::string &path,
+                      std::vector<size_t> records, size_t contentStart)
   {
-    _values.push_back(value);
+      _lazy = true;
+      _source = std::move(file);
+      _path = path;
+      _records = std::move(records);
+      _contentStart = contentStart;
+      clearCache();
   }
 
-  bool Row::set(const std::string &key, const std::string &value) 
+  void RowStore::clearCache(void)
   {
-    std::vector<std::string>::const_iterator it;
-    int pos = 0;
+      offsets.assign(LAZY_CACHE_ROWS * (columns + 1), 0);
+      _slotText.clear();
+      _slotRecord.clear();
+      _newer.clear();
+      _older.clear();
+      _newest = NONE;
+      _oldest = NONE;
+      _slotOf.clear();
+  }
 
-    for (it = _header.begin(); it != _header.end(); it++)
-    {
-        if (key == *it)
+  // read the whole file of a store opened from an index; when the
+  // content no longer starts after a newline the file has changed, and
+  // the header is looked for again
+  void RowStore::loadSource(void)
+  {
+      _source.reset();
+      BlockReader reader(_path);
+      const char *block;
+      size_t length;
+      buffer.clear();
+      while (reader.next(block, length))
+        buffer.append(block, length);
+
+      if (_contentStart > 0 && _contentStart <= buffer.size() && buffer[_contentStart - 1] == '\n')
+        return;
+      size_t start = 0;
+      while (start < buffer.size())
+      {
+        size_t end = recordEnd(start);
+        std::string_view record(buffer.data() + start, end - start);
+        start = end + 1;
+        if (acceptRecord(record, dialect))
+          break;
+      }
+      _contentStart = std::min(start, buffer.size());
+  }
+
+  // the file changed under its sidecar: read it whole, find every record
+  // again and drop the sidecar, so that the next open rebuilds it
+  void RowStore::rescan(void)
+  {
+      std::remove(indexPath(_path).c_str());
+      loadSource();
+      scan(_contentStart);
+  }
+
+  void RowStore::materialize(void)
+  {
+      if (!_lazy)
+        return;
+      // opened from an index: the file was never read
+      if (_source)
+        loadSource();
+      _lazy = false;
+      std::vector<size_t>().swap(_records);
+      std::vector<std::string>().swap(_slotText);
+      _slotRecord.clear();
+      _newer.clear();
+      _older.clear();
+      _slotOf.clear();
+      parse(_contentStart);
+  }
+
+  // the cache slot holding record, which is tokenized into the least
+  // recently used slot when it is not cached
+  size_t RowStore::fetch(size_t record)
+  {
+      auto cached = _slotOf.find(record);
+      if (cached != _slotOf.end())
+      {
+        touch(cached->second);
+        return cached->second;
+      }
+
+      if (record + 1 >= _records.size())
+        throw Error("can't return this row (doesn't exist)");
+
+      size_t slot;
+      if (_slotText.size() < LAZY_CACHE_ROWS)
+      {
+        slot = _slotText.size();
+        _slotText.emplace_back();
+        _slotRecord.push_back(NONE);
+        _newer.push_back(NONE);
+        _older.push_back(NONE);
+      }
+      else
+      {
+        slot = _oldest;
+        _slotOf.erase(_slotRecord[slot]);
+        _slotRecord[slot] = NONE;
+      }
+      touch(slot);
+
+      // a copy of the raw record, unescaped in place: the buffer stays raw.
+      // Everything up to the next record is copied (or read, with one pread
+      // when the buffer was never loaded), then cut at the record's end
+      size_t start = _records[record];
+      size_t length = _records[record + 1] - start;
+      std::string &text = _slotText[slot];
+      if (_source)
+      {
+        // with the byte before it, which ends the previous record: any
+        // other byte there means the sidecar's offsets are stale
+        text.resize(length + 1);
+        text.resize(_source->readAt(&text[0], length + 1, start - 1));
+        if (text.empty() || text[0] != '\n')
         {
-          _values[pos] = value;
-          return true;
+          rescan();
+          return fetch(record);
         }
-        pos++;
-    }
-    return false;
+        text.erase(0, 1);
+      }
+      else
+        text.assign(buffer, start, length);
+      RecordState state;
+      const char *newline = findRecordEnd(text.data(), text.size(), state, dialect);
+      std::string_view raw(text.data(), newline ? newline - text.data() : text.size());
+      acceptRecord(raw, dialect);
+      text.resize(raw.size());
+
+      size_t *rowOffsets = &offsets[slot * (columns + 1)];
+      size_t fields = 0;
+      size_t fieldEnd = 0;
+      detail::withTraits(dialect, [&](const auto &traits) {
+          splitFieldsInPlace(traits, text.data(), text.size(), [&](std::string_view value) {
+              if (fields < columns)
+                rowOffsets[fields] = value.data() - text.data();
+              fieldEnd = value.data() - text.data() + value.size();
+              fields++;
+          });
+      });
+      if (fields != columns)
+        throw Error("corrupted data !");
+      rowOffsets[columns] = fieldEnd + 1;
+
+      _slotRecord[slot] = record;
+      _slotOf[record] = slot;
+      return slot;
   }
 
-  const std::string Row::operator[](unsigned int valuePosition) const
+  // make slot the most recently used
+  void RowStore::touch(size_t slot)
   {
-       if (valuePosition < _values.size())
-           return _values[valuePosition];
-       throw Error("can't return this value (doesn't exist)");
+      if (slot == _newest)
+        return;
+      // unlink it; a new slot is not linked yet
+      if (_newer[slot] != NONE)
+      {
+        if (_older[slot] != NONE)
+          _newer[_older[slot]] = _newer[slot];
+        else
+          _oldest = _newer[slot];
+        _older[_newer[slot]] = _older[slot];
+      }
+      _older[slot] = _newest;
+      _newer[slot] = NONE;
+      if (_newest != NONE)
+        _newer[_newest] = slot;
+      else
+        _oldest = slot;
+      _newest = slot;
   }
 
-  const std::string Row::operator[](const std::string &key) const
+  void RowStore::reset(void)
   {
-      std::vector<std::string>::const_iterator it;
-      int pos = 0;
+      _rows = offsets.size() / (columns + 1);
+      _order.clear();
+      for (size_t first = 0; first < _rows; first += CHUNK_ROWS)
+      {
+        std::vector<size_t> &chunk = _order.emplace_back();
+        for (size_t physical = first; physical < std::min(_rows, first + CHUNK_ROWS); physical++)
+          chunk.push_back(physical);
+      }
+      updateStarts(0);
+      _deadRows = 0;
+      _deadBytes = 0;
+  }
+
+  // the chunk holding row, row < rows(); reads only, so concurrent readers are fine
+  size_t RowStore::chunkOf(size_t row) const
+  {
+      return std::upper_bound(_starts.begin(), _starts.end(), row) - _starts.begin() - 1;
+  }
 
-      for (it = _header.begin(); it != _header.end(); it++)
+  // edits only move the chunks after theirs: bring the starts from chunk on up to date
+  void RowStore::updateStarts(size_t chunk)
+  {
+      _starts.resize(_order.size());
+      size_t start = chunk ? _starts[chunk - 1] + _order[chunk - 1].size() : 0;
+      for (; chunk < _order.size(); chunk++)
       {
-          if (key == *it)
-              return _values[pos];
-          pos++;
+        _starts[chunk] = start;
+        start += _order[chunk].size();
       }
-      
+  }
+
+  size_t RowStore::physical(size_t row)
+  {
+      if (_lazy)
+        return fetch(row);
+      size_t chunk = chunkOf(row);
+      return _order[chunk][row - _starts[chunk]];
+  }
+
+  void RowStore::insertRow(size_t row, const std::vector<std::string_view> &values)
+  {
+      materialize();
+      size_t physical = appendRow(values);
+
+      if (_order.empty())
+        _order.emplace_back();
+      size_t chunk = row < _rows ? chunkOf(row) : _order.size() - 1;
+      size_t at = row < _rows ? row - _starts[chunk] : _order[chunk].size();
+      std::vector<size_t> &ids = _order[chunk];
+      ids.insert(ids.begin() + at, physical);
+      _rows++;
+
+      if (ids.size() >= 2 * CHUNK_ROWS)
+      {
+        std::vector<size_t> tail(ids.begin() + CHUNK_ROWS, ids.end());
+        ids.resize(CHUNK_ROWS);
+        _order.insert(_order.begin() + chunk + 1, std::move(tail));
+      }
+      updateStarts(chunk);
+  }
+
+  void RowStore::eraseRow(size_t row)
+  {
+      materialize();
+      size_t chunk = chunkOf(row);
+      std::vector<size_t> &ids = _order[chunk];
+      size_t physical = ids[row - _starts[chunk]];
+      ids.erase(ids.begin() + (row - _starts[chunk]));
+      _rows--;
+      if (ids.empty())
+        _order.erase(_order.begin() + chunk);
+      updateStarts(chunk);
+
+      const size_t *rowOffsets = &offsets[physical * (columns + 1)];
+      _deadBytes += rowOffsets[columns] - rowOffsets[0];
+      _deadRows++;
+      compactIfSparse();
+  }
+
+  void RowStore::setField(size_t physical, size_t column, std::string_view value)
+  {
+      if (_lazy)
+      {
+        // once parsed, the physical row of a record is its number
+        physical = _slotRecord[physical];
+        materialize();
+      }
+
+      std::vector<std::string_view> values;
+      for (size_t c = 0; c < columns; c++)
+        values.push_back(c == column ? value : field(physical, c));
+
+      size_t *rowOffsets = &offsets[physical * (columns + 1)];
+      _deadBytes += rowOffsets[columns] - rowOffsets[0];
+
+      size_t written = appendRow(values);
+      rowOffsets = &offsets[physical * (columns + 1)];
+      std::copy(offsets.end() - (columns + 1), offsets.end(), rowOffsets);
+      offsets.resize(written * (columns + 1));
+      compactIfSparse();
+  }
+
+  // write values out at the end of the buffer, as a new physical row
+  size_t RowStore::appendRow(const std::vector<std::string_view> &values)
+  {
+      // values may point into the buffer, which can move as it grows:
+      // the row is put together aside and appended in one go
+      std::string line;
+      for (size_t column = 0; column < values.size(); column++)
+      {
+        offsets.push_back(buffer.size() + line.size());
+        line.append(values[column]);
+        line.push_back(column + 1 < values.size() ? ',' : '\n');
+      }
+      offsets.push_back(buffer.size() + line.size());
+      buffer.append(line);
+      return offsets.size() / (columns + 1) - 1;
+  }
+
+  // once tombstones and stale bytes outweigh the live rows, rewrite the
+  // live rows in file order; paid for by the edits that left them behind
+  void RowStore::compactIfSparse(void)
+  {
+      if ((_deadRows < CHUNK_ROWS || _deadRows < _rows) &&
+          (_deadBytes < CHUNK_ROWS * 64 || _deadBytes < buffer.size() / 2))
+        return;
+
+      std::string packed;
+      std::vector<size_t> packedOffsets;
+      packed.reserve(buffer.size() - _deadBytes);
+      packedOffsets.reserve(_rows * (columns + 1));
+      forEachRow([&](size_t physical) {
+          const size_t *rowOffsets = &offsets[physical * (columns + 1)];
+          size_t shift = packed.size() - rowOffsets[0];
+          for (size_t c = 0; c <= columns; c++)
+            packedOffsets.push_back(rowOffsets[c] + shift);
+          // the last line of a file may have no newline to copy
+          packed.append(buffer, rowOffsets[0], rowOffsets[columns] - 1 - rowOffsets[0]);
+          packed.push_back('\n');
+      });
+      buffer.swap(packed);
+      offsets.swap(packedOffsets);
+      reset();
+  }
+
+  /*
+  ** COLUMN INDEX
+  */
+
+  ColumnIndex::ColumnIndex(const std::vector<std::string> &header)
+  {
+      for (unsigned int column = 0; column < header.size(); column++)
+        _sorted.emplace_back(header[column], column);
+      std::sort(_sorted.begin(), _sorted.end());
+  }
+
+  bool ColumnIndex::find(std::string_view name, unsigned int &column) const
+  {
+      auto it = std::lower_bound(_sorted.begin(), _sorted.end(), name,
+                                 [](const std::pair<std::string, unsigned int> &entry, std::string_view key) {
+                                     return std::string_view(entry.first) < key;
+                                 });
+      if (it == _sorted.end() || it->first != name)
+        return false;
+      column = it->second;
+      return true;
+  }
+
+  ColumnHandle ColumnIndex::handle(std::string_view name) const
+  {
+      unsigned int column;
+      if (!find(name, column))
+        throw Error(std::string("can't find column ").append(name));
+      return ColumnHandle(column);
+  }
+  
+  /*
+  ** ROW
+  */
+
+  Row::Row(RowStore *store, size_t physical, size_t record)
+      : _store(store), _physical(physical), _record(record) {}
+
+  unsigned int Row::size(void) const
+  {
+    return _store->columns;
+  }
+
+  bool Row::set(const std::string &key, const std::string &value) 
+  {
+    unsigned int pos;
+
+    if (!_store->index.find(key, pos))
+      return false;
+    _store->setField(physical(), pos, value);
+    return true;
+  }
+
+  void Row::set(const ColumnHandle &column, const std::string &value)
+  {
+    if (column.index() >= size())
+      throw Error("can't set this value (doesn't exist)");
+    _store->setField(physical(), column.index(), value);
+  }
+
+  std::string_view Row::operator[](unsigned int valuePosition) const
+  {
+       if (valuePosition < size())
+           return at_unchecked(valuePosition);
+       throw Error("can't return this value (doesn't exist)");
+  }
+
+  std::string_view Row::operator[](const std::string &key) const
+  {
+      unsigned int pos;
+
+      if (_store->index.find(key, pos))
+          return at_unchecked(pos);
+      throw Error("can't return this value (doesn't exist)");
+  }
+
+  std::string_view Row::operator[](const ColumnHandle &column) const
+  {
+      if (column.index() < size())
+          return at_unchecked(column);
       throw Error("can't return this value (doesn't exist)");
   }
 
   std::ostream &operator<<(std::ostream &os, const Row &row)
   {
-      for (unsigned int i = 0; i != row._values.size(); i++)
-          os << row._values[i] << " | ";
+      for (unsigned int i = 0; i != row.size(); i++)
+          os << row.at_unchecked(i) << " | ";
 
       return os;
   }
 
   std::ofstream &operator<<(std::ofstream &os, const Row &row)
   {
-    for (unsigned int i = 0; i != row._values.size(); i++)
-    {
-        os << row._values[i];
-        if (i < row._values.size() - 1)
-          os << ",";
-    }
+    writeFields(os, row.size(), [&row](size_t i) { return row.at_unchecked(i); }, row._store->dialect);
     return os;
   }
+
+  /*
+  ** STREAM PARSER
+  */
+
+  StreamParser::StreamParser(const std::string &file, size_t chunkSize, const Dialect &dialect)
+    : _file(file), _dialect(dialect), _source(file, chunkSize), _done(false), _stop(false),
+      _chunks(CHUNK_DEPTH), _batches(BATCH_DEPTH)
+  {
+      _reader = std::thread(&StreamParser::readLoop, this);
+      _tokenizer = std::thread(&StreamParser::tokenizeLoop, this);
+
+      // the header always arrives as the first row of the first batch
+      Batch batch;
+      if (!popBatch(batch) || batch.rows.empty())
+      {
+        shutdown();
+        throw Error(std::string("No Data in ").append(_file));
+      }
+      _header = batch.rows.front();
+      _pending.assign(std::make_move_iterator(batch.rows.begin() + 1),
+                      std::make_move_iterator(batch.rows.end()));
+      _error = batch.error;
+  }
+
+  StreamParser::~StreamParser(void)
+  {
+      shutdown();
+  }
+
+  // unblock both stages, drain whatever they still push and join them
+  void StreamParser::shutdown(void)
+  {
+      _stop = true;
+      Batch batch;
+      while (!_done)
+        popBatch(batch);
+      if (_reader.joinable())
+        _reader.join();
+      if (_tokenizer.joinable())
+        _tokenizer.join();
+  }
+
+  // reader stage: large block reads, one ring slot per block
+  void StreamParser::readLoop(void)
+  {
+      try
+      {
+        const char *block;
+        size_t length;
+        while (!_stop && _source.next(block, length))
+        {
+            Chunk chunk;
+            chunk.data.assign(block, length);
+            _chunks.push(std::move(chunk));
+        }
+      }
+      catch (const Error &e)
+      {
+        Chunk failed;
+        failed.error = e.what();
+        _chunks.push(std::move(failed));
+      }
+
+      Chunk end;
+      end.end = true;
+      _chunks.push(std::move(end));
+  }
+
+  // tokenizer stage: reassemble lines across blocks and split them into fields
+  void StreamParser::tokenizeLoop(void)
+  {
+      Batch batch;
+      LineSplitter lines(_dialect);
+      std::string scratch;
+      size_t columns = 0;
+      bool header = true;
+
+      auto addLine = [&](std::string_view line) {
+          if (!acceptRecord(line, _dialect) || !batch.error.empty())
+            return;
+          std::vector<std::string> fields;
+          splitFields(line, _dialect, scratch, [&fields](std::string_view value) { fields.emplace_back(value); });
+          if (header)
+            columns = fields.size();
+          else if (fields.size() != columns)
+          {
+            // rows before this one are still delivered, then the error
+            batch.error = "corrupted data !";
+            return;
+          }
+          header = false;
+          batch.rows.push_back(std::move(fields));
+      };
+
+      auto flush = [&]() {
+          bool failed = !batch.error.empty();
+          if (failed)
+            _stop = true; // nothing past the error is used, let the reader quit
+          _batches.push(std::move(batch));
+          batch = Batch();
+          return !failed;
+      };
+
+      Chunk chunk;
+      bool failed = false;
+      for (_chunks.pop(chunk); !chunk.end; _chunks.pop(chunk))
+      {
+          if (failed || _stop)
+            continue; // keep draining so the reader can finish
+
+          if (!chunk.error.empty())
+            batch.error = chunk.error;
+          else
+            lines.feed(chunk.data.data(), chunk.data.size(), addLine);
+
+          if (batch.rows.size() >= BATCH_ROWS || !batch.error.empty())
+            failed = !flush();
+      }
+
+      if (!failed && !_stop)
+      {
+        lines.finish(addLine);
+        if (!batch.rows.empty() || !batch.error.empty())
+          flush();
+      }
+
+      Batch end;
+      end.end = true;
+      _batches.push(std::move(end));
+  }
+
+  bool StreamParser::popBatch(Batch &batch)
+  {
+      if (_done)
+        return false;
+      _batches.pop(batch);
+      if (batch.end)
+      {
+        _done = true;
+        return false;
+      }
+      return true;
+  }
+
+  // hands the next rows to the caller; false once the whole file was read.
+  // A corrupted row is reported after every row before it was handed out.
+  bool StreamParser::nextBatch(RowBatch &rows)
+  {
+      rows.clear();
+      if (!_pending.empty())
+      {
+        rows.swap(_pending);
+        return true;
+      }
+      if (!_error.empty())
+      {
+        std::string error;
+        error.swap(_error);
+        throw Error(error);
+      }
+
+      Batch batch;
+      if (!popBatch(batch))
+        return false;
+      rows.swap(batch.rows);
+      _error = batch.error;
+      if (rows.empty())
+        return nextBatch(rows);
+      return true;
+  }
+
+  const std::vector<std::string> &StreamParser::getHeader(void) const
+  {
+      return _header;
+  }
+
+  const std::string &StreamParser::getFileName(void) const
+  {
+      return _file;
+  }
 }
@@ -1,11 +1,19 @@
 #ifndef     _CSVPARSER_HPP_
 # define    _CSVPARSER_HPP_
 
+# include <cstring>
+# include <memory>
 # include <stdexcept>
 # include <string>
+# include <string_view>
 # include <vector>
 # include <list>
+# include <unordered_map>
 # include <sstream>
+# include <atomic>
+# include <thread>
+# include "CSVreader.hpp"
+# include "SpscRing.hpp"
 
 namespace csv
 {
@@ -19,38 +27,672 @@ namespace csv
         }
     };
 
+    /*
+    ** How a CSV file is written. The defaults are RFC 4180 with LF line
+    ** ends: comma separated, fields quoted with ", "" for one quote
+    ** inside quotes.
+    */
+    struct Dialect
+    {
+        char separator = ',';
+        char quote = '"';
+        char escape = '"';   // the quote itself: "" inside quotes; any other (ex \): \" and \\ inside quotes
+        bool crlf = false;   // records end in \r\n, the \r is not part of the last field
+        bool trim = false;   // blanks around fields (outside their quotes) are dropped
+        char comment = '\0'; // records starting with it are skipped, '\0' for none
+    };
+
+    /*
+    ** Records are split into fields on the dialect's separator; a field
+    ** that starts with a quote runs to the matching closing quote, may
+    ** hold separators, newlines and escaped quotes, and is handed out
+    ** without its quotes. Anything between a closing quote and the next
+    ** separator is kept as it is, and an unterminated quote runs to the
+    ** end of the record.
+    **
+    ** The tokenizer finds each field as one or more raw segments (more
+    ** than one only around escapes) and gives them to a sink, which
+    ** decides where the field's text ends up.
+    */
+    namespace detail
+    {
+        inline const char *findByte(const char *from, const char *to, char byte)
+        {
+            return from == to ? nullptr : static_cast<const char *>(memchr(from, byte, to - from));
+        }
+
+        // the default dialect: every setting a constant, for the tightest loop
+        struct Rfc4180Traits
+        {
+            static constexpr char separator = ',';
+            static constexpr char quote = '"';
+            static constexpr char escape = '"';
+            static constexpr bool doubledQuotes = true;
+            static constexpr bool trim = false;
+        };
+
+        // any other dialect: the characters are read at run time, the
+        // choices that change the shape of the loop are fixed per instance
+        template <bool DoubledQuotes, bool Trim>
+        struct DialectTraits
+        {
+            char separator;
+            char quote;
+            char escape;
+            static constexpr bool doubledQuotes = DoubledQuotes;
+            static constexpr bool trim = Trim;
+        };
+
+        // call f once with the traits the tokenizer is specialized on for dialect
+        template <typename F>
+        void withTraits(const Dialect &dialect, F f)
+        {
+            bool doubled = dialect.escape == dialect.quote;
+            if (dialect.separator == ',' && dialect.quote == '"' && doubled && !dialect.trim)
+              f(Rfc4180Traits());
+            else if (doubled && !dialect.trim)
+              f(DialectTraits<true, false>{dialect.separator, dialect.quote, dialect.escape});
+            else if (doubled)
+              f(DialectTraits<true, true>{dialect.separator, dialect.quote, dialect.escape});
+            else if (!dialect.trim)
+              f(DialectTraits<false, false>{dialect.separator, dialect.quote, dialect.escape});
+            else
+              f(DialectTraits<false, true>{dialect.separator, dialect.quote, dialect.escape});
+        }
+
+        template <typename Traits>
+        bool isBlank(const Traits &traits, char c)
+        {
+            return (c == ' ' || c == '\t') && c != traits.separator;
+        }
+
+        template <typename Traits>
+        const char *skipBlanks(const Traits &traits, const char *from, const char *to)
+        {
+            while (from != to && isBlank(traits, *from))
+              from++;
+            return from;
+        }
+
+        template <typename Traits>
+        const char *dropBlanks(const Traits &traits, const char *from, const char *to)
+        {
+            while (to != from && isBlank(traits, to[-1]))
+              to--;
+            return to;
+        }
+
+        // the closing quote of a quoted field whose text starts at segment,
+        // or nullptr; every segment of its text but the last goes to sink
+        template <typename Traits, typename Sink>
+        const char *closeQuote(const Traits &traits, const char *&segment, const char *end, Sink &sink)
+        {
+            if constexpr (Traits::doubledQuotes)
+            {
+                for (;;)
+                {
+                    const char *quote = findByte(segment, end, traits.quote);
+                    if (quote == nullptr || quote + 1 == end || quote[1] != traits.quote)
+                      return quote;
+                    // "" stands for one quote: keep the first, skip the second
+                    sink.append(segment, quote + 1 - segment);
+                    segment = quote + 2;
+                }
+            }
+            else
+            {
+                for (const char *c = segment; c != end; c++)
+                {
+                    if (*c == traits.quote)
+                      return c;
+                    if (*c == traits.escape && c + 1 != end)
+                    {
+                      // the escape goes, the character after it stays
+                      sink.append(segment, c - segment);
+                      segment = ++c;
+                    }
+                }
+                return nullptr;
+            }
+        }
+
+        template <typename Traits, typename Sink, typename Push>
+        void tokenizeFields(const Traits &traits, const char *line, size_t length, Sink &sink, Push push)
+        {
+            const char *end = line + length;
+            const char *field = line;
+            for (;;)
+            {
+                const char *next;
+                sink.start();
+                if constexpr (Traits::trim)
+                  field = skipBlanks(traits, field, end);
+                if (field != end && *field == traits.quote)
+                {
+                    const char *segment = field + 1;
+                    const char *quote = closeQuote(traits, segment, end, sink);
+                    sink.append(segment, (quote ? quote : end) - segment);
+                    next = quote ? quote + 1 : end;
+                    if constexpr (Traits::trim)
+                    {
+                      const char *after = skipBlanks(traits, next, end);
+                      if (after == end || *after == traits.separator)
+                        next = after;
+                    }
+                    if (next != end && *next != traits.separator)
+                    {
+                      const char *separator = findByte(next, end, traits.separator);
+                      const char *stray = next;
+                      next = separator ? separator : end;
+                      if constexpr (Traits::trim)
+                        sink.append(stray, dropBlanks(traits, stray, next) - stray);
+                      else
+                        sink.append(stray, next - stray);
+                    }
+                }
+                else
+                {
+                    next = findByte(field, end, traits.separator);
+                    if (next == nullptr)
+                      next = end;
+                    if constexpr (Traits::trim)
+                      sink.append(field, dropBlanks(traits, field, next) - field);
+                    else
+                      sink.append(field, next - field);
+                }
+                push(sink.finish());
+                if (next == end)
+                  return;
+                field = next + 1;
+            }
+        }
+
+        /*
+        ** Hands out a field as a view into the record when it is a single
+        ** raw segment, and only puts it together in scratch otherwise.
+        ** Views stay valid until the next record: each field is built at
+        ** its own place in scratch, sized once for the whole record.
+        */
+        class BorrowingSink
+        {
+          public:
+            BorrowingSink(size_t length, std::string &scratch)
+              : _length(length), _scratch(scratch), _used(0) {}
+
+            void start(void)
+            {
+                _data = nullptr;
+                _size = 0;
+                _segments = 0;
+            }
+
+            void append(const char *data, size_t size)
+            {
+                if (_segments++ == 0)
+                {
+                  _data = data;
+                  _size = size;
+                  return;
+                }
+                if (_segments == 2)
+                {
+                  if (_scratch.size() < _length)
+                    _scratch.resize(_length);
+                  char *out = &_scratch[_used];
+                  memcpy(out, _data, _size);
+                  _data = out;
+                }
+                memcpy(&_scratch[_used + _size], data, size);
+                _size += size;
+            }
+
+            std::string_view finish(void)
+            {
+                if (_segments > 1)
+                  _used += _size;
+                return std::string_view(_data, _size);
+            }
+
+          private:
+            size_t _length;
+            std::string &_scratch;
+            size_t _used;
+            const char *_data;
+            size_t _size;
+            size_t _segments;
+        };
+
+        /*
+        ** Writes every field back over the record it came from, one after
+        ** the other with a one-byte gap where the comma was. The text only
+        ** moves once a field has been shortened, which never happens in a
+        ** record without quotes.
+        */
+        class CompactingSink
+        {
+          public:
+            CompactingSink(char *line) : _out(line) {}
+
+            void start(void)
+            {
+                _field = _out;
+            }
+
+            void append(const char *data, size_t size)
+            {
+                if (data != _out)
+                  memmove(_out, data, size);
+                _out += size;
+            }
+
+            std::string_view finish(void)
+            {
+                std::string_view field(_field, _out - _field);
+                _out++;
+                return field;
+            }
+
+          private:
+            char *_out;
+            char *_field;
+        };
+    }
+
+    /*
+    ** Split a record into its fields, handing each to push unescaped.
+    ** Fields are views into line where possible; those that had to be
+    ** unescaped live in scratch until the next call.
+    */
+    template <typename Push>
+    void splitFields(std::string_view line, const Dialect &dialect, std::string &scratch, Push push)
+    {
+        detail::BorrowingSink sink(line.size(), scratch);
+        detail::withTraits(dialect, [&](const auto &traits) {
+            detail::tokenizeFields(traits, line.data(), line.size(), sink, push);
+        });
+    }
+
+    template <typename Push>
+    void splitFields(std::string_view line, std::string &scratch, Push push)
+    {
+        detail::BorrowingSink sink(line.size(), scratch);
+        detail::tokenizeFields(detail::Rfc4180Traits(), line.data(), line.size(), sink, push);
+    }
+
+    template <typename Push>
+    void splitFields(std::string_view line, Push push)
+    {
+        std::string scratch;
+        splitFields(line, scratch, push);
+    }
+
+    /*
+    ** Same, unescaping each field over the record itself: the fields come
+    ** out packed from the start of line, each followed by one free byte.
+    */
+    template <typename Traits, typename Push>
+    void splitFieldsInPlace(const Traits &traits, char *line, size_t length, Push push)
+    {
+        detail::CompactingSink sink(line);
+        detail::tokenizeFields(traits, line, length, sink, push);
+    }
+
+    template <typename Push>
+    void splitFieldsInPlace(char *line, size_t length, Push push)
+    {
+        splitFieldsInPlace(detail::Rfc4180Traits(), line, length, push);
+    }
+
+    // where a scan for the end of a record stopped
+    struct RecordState
+    {
+        bool quoted = false;
+        bool escaped = false;
+        bool started = false; // the first byte of the record was seen
+        bool comment = false; // and it was the comment character
+    };
+
+    /*
+    ** The newline ending the record that data starts in, or nullptr when
+    ** it goes on past length. Newlines inside quotes do not end a record,
+    ** but a comment record runs to its newline whatever quotes it holds.
+    ** state carries where the scan stopped, so a record can be looked for
+    ** across several blocks; it is reset once the record's end is found.
+    */
+    inline const char *findRecordEnd(const char *data, size_t length, RecordState &state,
+                                     const Dialect &dialect = Dialect())
+    {
+        const char *end = data + length;
+        if (!state.started && data != end)
+        {
+            state.started = true;
+            state.comment = dialect.comment != '\0' && *data == dialect.comment;
+        }
+        if (state.comment)
+        {
+            const char *newline = detail::findByte(data, end, '\n');
+            if (newline != nullptr)
+              state = RecordState();
+            return newline;
+        }
+
+        if (dialect.escape != dialect.quote)
+        {
+            // escapes hide quotes: walk the bytes
+            for (; data != end; data++)
+            {
+                if (state.escaped)
+                  state.escaped = false;
+                else if (*data == dialect.quote)
+                  state.quoted = !state.quoted;
+                else if (state.quoted && *data == dialect.escape)
+                  state.escaped = true;
+                else if (!state.quoted && *data == '\n')
+                {
+                  state = RecordState();
+                  return data;
+                }
+            }
+            return nullptr;
+        }
+
+        // an escaped quote is two quotes: counting them is enough
+        while (data != end)
+        {
+            const char *newline = detail::findByte(data, end, '\n');
+            const char *stop = newline ? newline : end;
+            for (const char *quote = detail::findByte(data, stop, dialect.quote); quote != nullptr;
+                 quote = detail::findByte(quote + 1, stop, dialect.quote))
+              state.quoted = !state.quoted;
+            if (newline == nullptr)
+              return nullptr;
+            if (!state.quoted)
+            {
+              state = RecordState();
+              return newline;
+            }
+            data = newline + 1;
+        }
+        return nullptr;
+    }
+
+    // false for a record to skip (blank or a comment); drops the \r of a CRLF record
+    inline bool acceptRecord(std::string_view &record, const Dialect &dialect)
+    {
+        if (dialect.crlf && !record.empty() && record.back() == '\r')
+          record.remove_suffix(1);
+        return !record.empty() && (dialect.comment == '\0' || record.front() != dialect.comment);
+    }
+
+    /*
+    ** Reassembles records out of blocks that may cut them anywhere. A
+    ** record that sits whole inside a block is handed out as a view into
+    ** it; only records cut by a block boundary are copied. A newline
+    ** inside quotes is part of its record.
+    */
+    class LineSplitter
+    {
+      public:
+        LineSplitter(const Dialect &dialect = Dialect()) : _dialect(dialect) {}
+
+        template <typename OnLine>
+        void feed(const char *data, size_t length, OnLine onLine)
+        {
+            size_t lineStart = 0;
+            const char *newline;
+            while ((newline = findRecordEnd(data + lineStart, length - lineStart, _state, _dialect)) != nullptr)
+            {
+                size_t lineEnd = newline - data;
+                if (_carry.empty())
+                  onLine(std::string_view(data + lineStart, lineEnd - lineStart));
+                else
+                {
+                  _carry.append(data + lineStart, lineEnd - lineStart);
+                  onLine(std::string_view(_carry));
+                  _carry.clear();
+                }
+                lineStart = lineEnd + 1;
+            }
+            _carry.append(data + lineStart, length - lineStart);
+        }
+
+        // the last record when the file does not end with a newline
+        template <typename OnLine>
+        void finish(OnLine onLine)
+        {
+            if (!_carry.empty())
+              onLine(std::string_view(_carry));
+            _carry.clear();
+            _state = RecordState();
+        }
+
+      private:
+        Dialect _dialect;
+        std::string _carry;
+        RecordState _state;
+    };
+
+    /*
+    ** A column found by name once (Parser::column) and reused for every
+    ** row, so named access per row is a single array index.
+    */
+    class ColumnHandle
+    {
+      public:
+        explicit ColumnHandle(unsigned int column) : _column(column) {}
+
+        unsigned int index(void) const { return _column; }
+
+      private:
+        unsigned int _column;
+    };
+
+    /*
+    ** Column name to column index, built once per header and shared by
+    ** every row of the file. The names are kept sorted, so a lookup is a
+    ** binary search instead of a scan of the header; when a name appears
+    ** twice the first column wins, as it did with the scan.
+    */
+    class ColumnIndex
+    {
+      public:
+        ColumnIndex(void) {}
+        ColumnIndex(const std::vector<std::string> &header);
+
+        bool find(std::string_view name, unsigned int &column) const;
+        ColumnHandle handle(std::string_view name) const;
+
+      private:
+        std::vector<std::pair<std::string, unsigned int> > _sorted;
+    };
+
+    /*
+    ** Every field of a parsed file, held in one character buffer (the file
+    ** text itself) and located through one flat offset array. Physical row
+    ** r owns columns + 1 consecutive offsets starting at r * (columns + 1):
+    ** the start of each field, then one past the end of the row, so field
+    ** c runs from offsets[k + c] up to the separator before offsets[k + c + 1].
+    ** A file costs a couple of allocations instead of several per row,
+    ** and walking the rows walks memory in order.
+    **
+    ** The file order is kept apart, as physical row numbers in chunks of
+    ** about CHUNK_ROWS: adding or deleting a row only shifts the ids of
+    ** one chunk and the starts of the chunks after it, and a position is
+    ** found by a binary search over those starts. Reading a parsed store
+    ** changes nothing, so several threads may read its rows at once. A
+    ** deleted row stays behind as a tombstone, and an edited or added row
+    ** is written out again at the end of the buffer; once half the store
+    ** is dead it is compacted back into file order.
+    ** Views into the buffer, and physical row numbers, are invalidated by
+    ** any edit.
+    */
+    class RowStore
+    {
+      public:
+        // rows in the file, in order
+        size_t rows(void) const
+        {
+            return _lazy ? _records.size() - 1 : _rows;
+        }
+
+        std::string_view field(size_t physical, size_t column) const
+        {
+            const size_t *start = &offsets[physical * (columns + 1) + column];
+            const char *text = _lazy ? _slotText[physical].data() : buffer.data();
+            return std::string_view(text + start[0], start[1] - start[0] - 1);
+        }
+
+        // the end of the record starting at start: its newline, or the end of the buffer
+        size_t recordEnd(size_t start) const;
+        // tokenize every record from start on
+        void parse(size_t start);
+        // lazy: only find where the records from start on begin
+        void scan(size_t start);
+        // lazy, from an index: the records are read from file as they are fetched
+        void open(std::unique_ptr<FileReader> file, const std::string &path,
+                  std::vector<size_t> records, size_t contentStart);
+        // lazy: where each record starts, then the end of the file
+        const std::vector<size_t> &records(void) const
+        {
+            return _records;
+        }
+        // lazy to parsed, before any edit
+        void materialize(void);
+
+        bool lazy(void) const
+        {
+            return _lazy;
+        }
+        // lazy: the slot holding record, slot itself while it still does
+        size_t resident(size_t record, size_t slot)
+        {
+            if (!_lazy)
+              return record; // parsed since, and a parsed record's row is its number
+            return _slotRecord[slot] == record ? slot : fetch(record);
+        }
+
+        // once parsed: every row of offsets, in order
+        void reset(void);
+        size_t physical(size_t row);
+        void insertRow(size_t row, const std::vector<std::string_view> &values);
+        void eraseRow(size_t row);
+        void setField(size_t physical, size_t column, std::string_view value);
+
+        // calls f with the physical number of every row, in order
+        template <typename F>
+        void forEachRow(F f) const
+        {
+            for (const std::vector<size_t> &chunk : _order)
+              for (size_t physical : chunk)
+                f(physical);
+        }
+
+      private:
+        size_t appendRow(const std::vector<std::string_view> &values);
+        size_t chunkOf(size_t row) const;
+        void updateStarts(size_t chunk);
+        void compactIfSparse(void);
+        size_t fetch(size_t record);
+        void loadSource(void);
+        void rescan(void);
+        void touch(size_t slot);
+        void clearCache(void);
+
+      public:
+        std::string buffer;
+        std::vector<size_t> offsets;
+        size_t columns = 0;
+        ColumnIndex index;
+        Dialect dialect;
+
+      private:
+        std::vector<std::vector<size_t> > _order;
+        std::vector<size_t> _starts; // first row of each chunk
+        size_t _rows = 0;
+        size_t _deadRows = 0;
+        size_t _deadBytes = 0;
+
+        // lazy mode: the buffer is left raw, a physical row is a cache slot
+        // holding one record, copied out and tokenized on first use
+        bool _lazy = false;
+        size_t _contentStart = 0;
+        std::vector<size_t> _records;        // where each record starts, then the end
+        std::unique_ptr<FileReader> _source; // set when the buffer was never read
+        std::string _path;
+        std::vector<std::string> _slotText;
+        std::vector<size_t> _slotRecord;
+        std::vector<size_t> _newer;          // least recently used list over the slots
+        std::vector<size_t> _older;
+        size_t _newest = 0;
+        size_t _oldest = 0;
+        std::unordered_map<size_t, size_t> _slotOf;
+    };
+
+    /*
+    ** One row of a Parser: a view of its fields in the parser's RowStore,
+    ** cheap to copy. Fields handed out are views as well; like the Row,
+    ** they are invalidated when the parser's rows are edited. A Row of a
+    ** lazy parser remembers its record and tokenizes it again once its
+    ** cache slot has been reused; views taken from it before that point
+    ** into the old slot and are only valid until a few hundred other rows
+    ** have been fetched.
+    */
     class Row
     {
     	public:
-    	    Row(const std::vector<std::string> &);
-    	    ~Row(void);
+    	    // record of a row that does not come from a lazy parser
+    	    static const size_t NO_RECORD = static_cast<size_t>(-1);
+
+    	    Row(RowStore *store, size_t physical, size_t record = NO_RECORD);
 
     	public:
             unsigned int size(void) const;
-            void push(const std::string &);
             bool set(const std::string &, const std::string &); 
+            void set(const ColumnHandle &, const std::string &);
 
     	private:
-    		const std::vector<std::string> _header;
-    		std::vector<std::string> _values;
+    		RowStore *_store;
+    		mutable size_t _physical; // lazy: the slot last seen holding _record
+    		size_t _record;
+
+            // the physical row to read, fetched again when a lazy row was evicted
+            size_t physical(void) const
+            {
+                if (_record != NO_RECORD)
+                  _physical = _store->resident(_record, _physical);
+                return _physical;
+            }
 
         public:
 
             template<typename T>
             const T getValue(unsigned int pos) const
             {
-                if (pos < _values.size())
+                if (pos < size())
                 {
                     T res;
                     std::stringstream ss;
-                    ss << _values[pos];
+                    ss << at_unchecked(pos);
                     ss >> res;
                     return res;
                 }
                 throw Error("can't return this value (doesn't exist)");
             }
-            const std::string operator[](unsigned int) const;
-            const std::string operator[](const std::string &valueName) const;
+            std::string_view operator[](unsigned int) const;
+            std::string_view operator[](const std::string &valueName) const;
+            std::string_view operator[](const ColumnHandle &column) const;
+
+            // no bounds check, for hot loops over rows already known to be full width
+            std::string_view at_unchecked(unsigned int pos) const
+            {
+                return _store->field(physical(), pos);
+            }
+
+            std::string_view at_unchecked(const ColumnHandle &column) const
+            {
+                return _store->field(physical(), column.index());
+            }
+
             friend std::ostream& operator<<(std::ostream& os, const Row &row);
             friend std::ofstream& operator<<(std::ofstream& os, const Row &row);
     };
@@ -60,40 +702,111 @@ namespace csv
         ePURE = 1
     };
 
+    // A lazy parser (eLAZY, eINDEXED) updates its row cache on every read,
+    // even through const members, so it must not be read from several
+    // threads at once; an eager parser can be.
+    enum LoadMode {
+        eEAGER = 0,  // every row tokenized by the constructor
+        eLAZY = 1,   // rows tokenized on first access, the last few cached
+        eINDEXED = 2 // lazy, with where the records start kept in file.idx
+    };
+
     class Parser
     {
 
     public:
         Parser(const std::string &, const DataType &type = eFILE, char sep = ',');
+        Parser(const std::string &, const DataType &type, const Dialect &dialect, LoadMode mode = eEAGER);
         ~Parser(void);
 
     public:
-        Row &getRow(unsigned int row) const;
+        Row getRow(unsigned int row) const;
         unsigned int rowCount(void) const;
         unsigned int columnCount(void) const;
-        std::vector<std::string> getHeader(void) const;
-        const std::string getHeaderElement(unsigned int pos) const;
+        const std::vector<std::string> &getHeader(void) const;
+        const std::string &getHeaderElement(unsigned int pos) const;
         const std::string &getFileName(void) const;
+        ColumnHandle column(const std::string &name) const;
 
     public:
         bool deleteRow(unsigned int row);
         bool addRow(unsigned int pos, const std::vector<std::string> &);
-        void sync(void) const;
+        void sync(void) const; // throws for a compressed file, which it cannot write back
 
     protected:
-    	void parseHeader(void);
-    	void parseContent(void);
+    	void parseHeader(std::string_view line);
+    	bool loadIndex(void);
+    	void saveIndex(size_t headerStart, size_t contentStart) const;
+    	void parseContent(size_t start);
 
     private:
         std::string _file;
         const DataType _type;
-        const char _sep;
-        std::vector<std::string> _originalFile;
+        const Dialect _dialect;
+        const LoadMode _mode;
+        Compression _compression;
         std::vector<std::string> _header;
-        std::vector<Row *> _content;
+        std::unique_ptr<RowStore> _rows;
+
+    public:
+        Row operator[](unsigned int row) const;
+    };
+
+    typedef std::vector<std::vector<std::string> > RowBatch;
+
+    /*
+    ** Streams a CSV file through a reader thread (large block reads through
+    ** a BlockReader, so io_uring where available and gzip/zstd decoded on
+    ** the fly) and a tokenizer thread (line splitting and field parsing),
+    ** connected by a bounded SPSC ring. Parsed rows come out in batches, in
+    ** file order, on the caller's thread, so a consumer overlaps with both
+    ** stages.
+    */
+    class StreamParser
+    {
+
+    public:
+        StreamParser(const std::string &file, size_t chunkSize = 1 << 20, const Dialect &dialect = Dialect());
+        ~StreamParser(void);
 
     public:
-        Row &operator[](unsigned int row) const;
+        bool nextBatch(RowBatch &rows);
+        const std::vector<std::string> &getHeader(void) const;
+        const std::string &getFileName(void) const;
+
+    private:
+        struct Chunk
+        {
+            std::string data;
+            std::string error;
+            bool end = false;
+        };
+
+        struct Batch
+        {
+            RowBatch rows;
+            std::string error;
+            bool end = false;
+        };
+
+        void readLoop(void);
+        void tokenizeLoop(void);
+        bool popBatch(Batch &batch);
+        void shutdown(void);
+
+    private:
+        std::string _file;
+        const Dialect _dialect;
+        BlockReader _source;
+        std::vector<std::string> _header;
+        RowBatch _pending;
+        std::string _error;
+        bool _done;
+        std::atomic<bool> _stop;
+        SpscRing<Chunk> _chunks;
+        SpscRing<Batch> _batches;
+        std::thread _reader;
+        std::thread _tokenizer;
     };
 }
 
@@ -0,0 +1,831 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+# define CSV_HAVE_IO_URING 1
+# include <linux/io_uring.h>
+# include <sys/mman.h>
+# include <sys/syscall.h>
+#endif
+#ifdef CSV_HAVE_ZLIB
+# include <zlib.h>
+#endif
+#ifdef CSV_HAVE_ZSTD
+# include <zstd.h>
+# include <zstd_errors.h>
+#endif
+#include "CSVreader.hpp"
+#include "CSVparser.hpp"
+
+namespace csv {
+
+  namespace {
+    // block buffers start on a page boundary
+    const size_t BLOCK_ALIGN = 4096;
+
+    char *allocBlock(size_t size)
+    {
+        return static_cast<char *>(::operator new(size, std::align_val_t(BLOCK_ALIGN)));
+    }
+
+    void freeBlock(char *block)
+    {
+        ::operator delete(block, std::align_val_t(BLOCK_ALIGN));
+    }
+
+    // independent compressed blocks decoded per parallel batch
+    const size_t PARALLEL_UNITS = 64;
+
+    // the decoded sizes come from the file's own headers, so they are
+    // bounded before anything is allocated for them: a BGZF block holds
+    // at most 64 KiB, a zstd frame at most this many reader blocks, and
+    // a batch stops growing past the batch limit
+    const size_t BGZF_MAX_BLOCK = 64 * 1024;
+    const size_t PARALLEL_FRAME_BLOCKS = 4;
+    const size_t PARALLEL_BATCH_BLOCKS = 16;
+
+#ifdef CSV_HAVE_ZLIB
+    // gzip member carrying a BGZF block size (BC extra subfield)
+    bool isBgzf(const unsigned char *p, size_t length)
+    {
+        return length >= 18 && p[0] == 0x1f && p[1] == 0x8b && p[2] == 8 && (p[3] & 4)
+            && (p[10] | (p[11] << 8)) >= 6 && p[12] == 'B' && p[13] == 'C'
+            && (p[14] | (p[15] << 8)) == 2;
+    }
+#endif
+
+    template <typename T>
+    T loadAcquire(T *shared)
+    {
+        return std::atomic_ref<T>(*shared).load(std::memory_order_acquire);
+    }
+
+    template <typename T>
+    void storeRelease(T *shared, T value)
+    {
+        std::atomic_ref<T>(*shared).store(value, std::memory_order_release);
+    }
+  }
+
+  FileReader::FileReader(const std::string &file, size_t blockSize,
+                         unsigned int depth, bool useIoUring)
+    : _file(file), _fd(-1), _regular(false), _fileSize(0), _modified(0), _changed(0), _inode(0),
+      _blockSize(std::max<size_t>(blockSize, 1)), _nextSubmit(0), _nextDeliver(0), _lent(nullptr),
+      _ringFd(-1), _sqRing(nullptr), _sqRingSize(0), _cqRing(nullptr), _cqRingSize(0),
+      _sqes(nullptr), _sqesSize(0), _sqTail(nullptr), _sqMask(nullptr), _sqArray(nullptr),
+      _cqHead(nullptr), _cqTail(nullptr), _cqMask(nullptr), _cqes(nullptr)
+  {
+#ifdef _WIN32
+      _fd = ::_open(_file.c_str(), _O_RDONLY | _O_BINARY);
+#else
+      _fd = ::open(_file.c_str(), O_RDONLY);
+#endif
+      struct stat info;
+      if (_fd < 0 || ::fstat(_fd, &info) != 0)
+      {
+        if (_fd >= 0)
+          ::close(_fd);
+        throw Error(std::string("Failed to open ").append(_file));
+      }
+      // pipes and devices (ex /dev/stdin) have no size to plan reads
+      // with: they are read front to back, one block at a time
+      _regular = S_ISREG(info.st_mode);
+      _fileSize = _regular ? info.st_size : 0;
+      // to the nanosecond where the platform keeps it: a rewrite within
+      // the same second is a different file
+#if defined(__APPLE__)
+      _modified = info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+      _changed = info.st_ctimespec.tv_sec * 1000000000LL + info.st_ctimespec.tv_nsec;
+#elif defined(_WIN32)
+      _modified = info.st_mtime * 1000000000LL;
+      _changed = info.st_ctime * 1000000000LL;
+#else
+      _modified = info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+      _changed = info.st_ctim.tv_sec * 1000000000LL + info.st_ctim.tv_nsec;
+#endif
+      _inode = info.st_ino;
+
+      try
+      {
+        // the pread path only ever needs one block
+        if (!_regular || !useIoUring || !setupRing(std::max(depth, 1u)))
+          depth = 1;
+        _slots.resize(std::max(depth, 1u));
+        for (Slot &slot : _slots)
+          slot.buffer = allocBlock(_blockSize);
+
+        // keep every slot in flight from the start
+        if (usesIoUring())
+        {
+          for (Slot &slot : _slots)
+            if (_nextSubmit < _fileSize)
+              submit(slot);
+        }
+      }
+      catch (...)
+      {
+        release();
+        throw;
+      }
+  }
+
+  FileReader::~FileReader(void)
+  {
+      release();
+  }
+
+  // give back the ring, the blocks and the file
+  void FileReader::release(void)
+  {
+      // the kernel may still be writing into buffers, wait for it first
+      try
+      {
+        while (usesIoUring() && std::any_of(_slots.begin(), _slots.end(),
+                                            [](const Slot &slot) { return slot.busy; }))
+          reap();
+      }
+      catch (const Error &)
+      {
+      }
+      teardownRing();
+      for (Slot &slot : _slots)
+        freeBlock(slot.buffer);
+      _slots.clear();
+      ::close(_fd);
+      _fd = -1;
+  }
+
+  // hands out the next block in file order; the data stays valid until the next call
+  bool FileReader::next(const char *&data, size_t &length)
+  {
+      // the caller is done with the previous block, reuse its buffer
+      if (_lent != nullptr)
+      {
+        _lent->ready = false;
+        if (usesIoUring() && _nextSubmit < _fileSize)
+          submit(*_lent);
+        _lent = nullptr;
+      }
+      if (_regular && _nextDeliver >= _fileSize)
+        return false;
+
+      Slot *slot = nullptr;
+      size_t expected = std::min(_blockSize, _fileSize - _nextDeliver);
+      if (!_regular)
+      {
+        // the size is only known once the stream ends
+        slot = &_slots[0];
+        slot->offset = _nextDeliver;
+        slot->length = readStream(slot->buffer, _blockSize);
+        expected = slot->length;
+        _fileSize += slot->length;
+      }
+      else if (usesIoUring())
+      {
+        // completions arrive in any order, wait for the block due next
+        while (slot == nullptr)
+        {
+          for (Slot &candidate : _slots)
+            if (candidate.ready && candidate.offset == _nextDeliver)
+              slot = &candidate;
+          if (slot == nullptr)
+            reap();
+        }
+      }
+      else
+      {
+        slot = &_slots[0];
+        slot->offset = _nextDeliver;
+        slot->length = readAt(slot->buffer, expected, _nextDeliver);
+      }
+
+      // a short block means the file was truncated while reading
+      if (slot->length < expected)
+        _fileSize = _nextDeliver + slot->length;
+      if (slot->length == 0)
+        return false;
+
+      _nextDeliver += slot->length;
+      _lent = slot;
+      data = slot->buffer;
+      length = slot->length;
+      return true;
+  }
+
+  size_t FileReader::fileSize(void) const
+  {
+      return _fileSize;
+  }
+
+  long long FileReader::modified(void) const
+  {
+      return _modified;
+  }
+
+  long long FileReader::changed(void) const
+  {
+      return _changed;
+  }
+
+  unsigned long long FileReader::inode(void) const
+  {
+      return _inode;
+  }
+
+  bool FileReader::isRegular(void) const
+  {
+      return _regular;
+  }
+
+  bool FileReader::usesIoUring(void) const
+  {
+      return _ringFd >= 0;
+  }
+
+  // blocking read of up to length bytes; fewer only at end of file
+  size_t FileReader::readAt(char *buffer, size_t length, size_t offset) const
+  {
+      size_t done = 0;
+      while (done < length)
+      {
+#ifdef _WIN32
+        long long got = -1;
+        if (::_lseeki64(_fd, offset + done, SEEK_SET) >= 0)
+          got = ::_read(_fd, buffer + done, static_cast<unsigned int>(length - done));
+#else
+        ssize_t got = ::pread(_fd, buffer + done, length - done, offset + done);
+#endif
+        if (got < 0 && errno == EINTR)
+          continue;
+        if (got < 0)
+          throw Error(std::string("Failed to read ").append(_file));
+        if (got == 0)
+          break;
+        done += got;
+      }
+      return done;
+  }
+
+  // read the next length bytes of a pipe or device; fewer only at its end
+  size_t FileReader::readStream(char *buffer, size_t length)
+  {
+      size_t done = 0;
+      while (done < length)
+      {
+#ifdef _WIN32
+        long long got = ::_read(_fd, buffer + done, static_cast<unsigned int>(length - done));
+#else
+        ssize_t got = ::read(_fd, buffer + done, length - done);
+#endif
+        if (got < 0 && errno == EINTR)
+          continue;
+        if (got < 0)
+          throw Error(std::string("Failed to read ").append(_file));
+        if (got == 0)
+          break;
+        done += got;
+      }
+      return done;
+  }
+
+#ifdef CSV_HAVE_IO_URING
+  bool FileReader::setupRing(unsigned int depth)
+  {
+      io_uring_params params;
+      std::memset(&params, 0, sizeof(params));
+      int ringFd = ::syscall(__NR_io_uring_setup, depth, &params);
+      if (ringFd < 0)
+        return false; // ENOSYS, EPERM under seccomp, ...
+      _ringFd = ringFd;
+
+      _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+      _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      if (params.features & IORING_FEAT_SINGLE_MMAP)
+        _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+
+      _sqRing = ::mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQ_RING);
+      if (_sqRing == MAP_FAILED)
+      {
+        _sqRing = nullptr;
+        teardownRing();
+        return false;
+      }
+      if (params.features & IORING_FEAT_SINGLE_MMAP)
+        _cqRing = _sqRing;
+      else
+      {
+        _cqRing = ::mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_CQ_RING);
+        if (_cqRing == MAP_FAILED)
+        {
+          _cqRing = nullptr;
+          teardownRing();
+          return false;
+        }
+      }
+      _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+      _sqes = ::mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQES);
+      if (_sqes == MAP_FAILED)
+      {
+        _sqes = nullptr;
+        teardownRing();
+        return false;
+      }
+
+      char *sq = static_cast<char *>(_sqRing);
+      char *cq = static_cast<char *>(_cqRing);
+      _sqTail = reinterpret_cast<unsigned int *>(sq + params.sq_off.tail);
+      _sqMask = reinterpret_cast<unsigned int *>(sq + params.sq_off.ring_mask);
+      _sqArray = reinterpret_cast<unsigned int *>(sq + params.sq_off.array);
+      _cqHead = reinterpret_cast<unsigned int *>(cq + params.cq_off.head);
+      _cqTail = reinterpret_cast<unsigned int *>(cq + params.cq_off.tail);
+      _cqMask = reinterpret_cast<unsigned int *>(cq + params.cq_off.ring_mask);
+      _cqes = cq + params.cq_off.cqes;
+      return true;
+  }
+
+  void FileReader::teardownRing(void)
+  {
+      if (_sqes != nullptr)
+        ::munmap(_sqes, _sqesSize);
+      if (_cqRing != nullptr && _cqRing != _sqRing)
+        ::munmap(_cqRing, _cqRingSize);
+      if (_sqRing != nullptr)
+        ::munmap(_sqRing, _sqRingSize);
+      if (_ringFd >= 0)
+        ::close(_ringFd);
+      _sqes = _cqRing = _sqRing = nullptr;
+      _ringFd = -1;
+  }
+
+  // queue a read of the next unrequested block into slot
+  void FileReader::submit(Slot &slot)
+  {
+      slot.offset = _nextSubmit;
+      slot.length = std::min(_blockSize, _fileSize - _nextSubmit);
+      slot.busy = true;
+      slot.ready = false;
+      _nextSubmit += slot.length;
+
+      unsigned int tail = *_sqTail;
+      unsigned int index = tail & *_sqMask;
+      io_uring_sqe *sqe = static_cast<io_uring_sqe *>(_sqes) + index;
+      std::memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_READ;
+      sqe->fd = _fd;
+      sqe->addr = reinterpret_cast<unsigned long long>(slot.buffer);
+      sqe->len = slot.length;
+      sqe->off = slot.offset;
+      sqe->user_data = &slot - &_slots[0];
+      _sqArray[index] = index;
+      storeRelease(_sqTail, tail + 1);
+
+      while (::syscall(__NR_io_uring_enter, _ringFd, 1, 0, 0, nullptr, 0) < 0)
+        if (errno != EINTR)
+          throw Error(std::string("Failed to read ").append(_file));
+  }
+
+  // wait for at least one completion and mark the finished slots ready
+  void FileReader::reap(void)
+  {
+      unsigned int head = *_cqHead;
+      while (head == loadAcquire(_cqTail))
+        if (::syscall(__NR_io_uring_enter, _ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0
+            && errno != EINTR)
+          throw Error(std::string("Failed to read ").append(_file));
+
+      for (unsigned int tail = loadAcquire(_cqTail); head != tail; head++)
+      {
+        const io_uring_cqe *cqe = static_cast<io_uring_cqe *>(_cqes) + (head & *_cqMask);
+        Slot &slot = _slots[cqe->user_data];
+        int res = cqe->res;
+        storeRelease(_cqHead, head + 1);
+
+        slot.busy = false;
+        slot.ready = true;
+        // a kernel without IORING_OP_READ fails it, finish such blocks with pread
+        if (res < 0)
+          slot.length = readAt(slot.buffer, slot.length, slot.offset);
+        else if (static_cast<size_t>(res) < slot.length)
+          slot.length = res + readAt(slot.buffer + res, slot.length - res, slot.offset + res);
+      }
+  }
+#else
+  bool FileReader::setupRing(unsigned int)
+  {
+      return false;
+  }
+
+  void FileReader::teardownRing(void)
+  {
+  }
+
+  void FileReader::submit(Slot &)
+  {
+  }
+
+  void FileReader::reap(void)
+  {
+  }
+#endif
+
+  /*
+  ** BLOCK READER
+  */
+
+  BlockReader::BlockReader(const std::string &file, size_t blockSize)
+    : _file(file), _source(file, blockSize), _blockSize(std::max<size_t>(blockSize, 1)),
+      _compression(eNONE), _parallel(false), _peek(nullptr), _peekLength(0),
+      _raw(nullptr), _rawLength(0), _rawPos(0), _midStream(false), _stream(nullptr)
+  {
+      if (!_source.next(_peek, _peekLength))
+      {
+        _peek = nullptr;
+        return; // empty file
+      }
+
+      const unsigned char *magic = reinterpret_cast<const unsigned char *>(_peek);
+      if (_peekLength >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+        _compression = eGZIP;
+      else if (_peekLength >= 4 && magic[0] == 0x28 && magic[1] == 0xb5
+               && magic[2] == 0x2f && magic[3] == 0xfd)
+        _compression = eZSTD;
+
+      if (_compression == eGZIP)
+      {
+#ifdef CSV_HAVE_ZLIB
+        _parallel = isBgzf(magic, _peekLength);
+#else
+        throw Error(std::string("gzip input needs a build with zlib: ").append(_file));
+#endif
+      }
+      else if (_compression == eZSTD)
+      {
+#ifdef CSV_HAVE_ZSTD
+        // several whole frames with recorded sizes in the first block:
+        // the frames can be decoded independently
+        size_t first = ZSTD_findFrameCompressedSize(_peek, _peekLength);
+        unsigned long long decoded = ZSTD_getFrameContentSize(_peek, _peekLength);
+        _parallel = !ZSTD_isError(first) && first < _peekLength
+                    && decoded != ZSTD_CONTENTSIZE_UNKNOWN && decoded != ZSTD_CONTENTSIZE_ERROR;
+#else
+        throw Error(std::string("zstd input needs a build with libzstd: ").append(_file));
+#endif
+      }
+      if (_compression != eNONE && !_parallel)
+        startStream();
+  }
+
+  BlockReader::~BlockReader(void)
+  {
+#ifdef CSV_HAVE_ZLIB
+      if (_compression == eGZIP && _stream != nullptr)
+      {
+        inflateEnd(static_cast<z_stream *>(_stream));
+        delete static_cast<z_stream *>(_stream);
+      }
+#endif
+#ifdef CSV_HAVE_ZSTD
+      if (_compression == eZSTD && _stream != nullptr)
+        ZSTD_freeDCtx(static_cast<ZSTD_DCtx *>(_stream));
+#endif
+  }
+
+  // hands out the next decoded block; the data stays valid until the next call
+  bool BlockReader::next(const char *&data, size_t &length)
+  {
+      if (_compression == eNONE)
+      {
+        if (!pullRaw())
+          return false;
+        _rawPos = _rawLength;
+        data = _raw;
+        length = _rawLength;
+        return true;
+      }
+
+      bool more;
+      do
+      {
+        if (_parallel)
+          more = decodeBatch();
+        else if (_compression == eGZIP)
+          more = inflateStream();
+        else
+          more = decompressStream();
+      } while (more && _out.empty());
+
+      data = _out.data();
+      length = _out.size();
+      return more;
+  }
+
+  Compression BlockReader::compression(void) const
+  {
+      return _compression;
+  }
+
+  bool BlockReader::isParallel(void) const
+  {
+      return _parallel;
+  }
+
+  // make the next raw block current; false at end of file
+  bool BlockReader::pullRaw(void)
+  {
+      const char *data = _peek;
+      size_t length = _peekLength;
+      if (_peek != nullptr)
+        _peek = nullptr;
+      else if (!_source.next(data, length))
+        return false;
+      _raw = data;
+      _rawLength = length;
+      _rawPos = 0;
+      return true;
+  }
+
+  // decode the rest of the file with the streaming decoder, from _raw + _rawPos on
+  void BlockReader::startStream(void)
+  {
+      _parallel = false;
+      _midStream = false;
+#ifdef CSV_HAVE_ZLIB
+      if (_compression == eGZIP)
+      {
+        z_stream *zs = new z_stream();
+        if (inflateInit2(zs, 15 + 16) != Z_OK)
+        {
+          delete zs;
+          throw Error(std::string("Failed to start gzip decoding of ").append(_file));
+        }
+        _stream = zs;
+      }
+#endif
+#ifdef CSV_HAVE_ZSTD
+      if (_compression == eZSTD)
+      {
+        _stream = ZSTD_createDCtx();
+        if (_stream == nullptr)
+          throw Error(std::string("Failed to start zstd decoding of ").append(_file));
+      }
+#endif
+  }
+
+  // streaming gzip: fill one output block, pulling raw blocks as needed
+  bool BlockReader::inflateStream(void)
+  {
+#ifdef CSV_HAVE_ZLIB
+      z_stream *zs = static_cast<z_stream *>(_stream);
+      _out.resize(_blockSize);
+      zs->next_out = reinterpret_cast<Bytef *>(&_out[0]);
+      zs->avail_out = static_cast<uInt>(_blockSize);
+      while (zs->avail_out > 0)
+      {
+          bool eof = _rawPos == _rawLength && !pullRaw();
+          if (eof && !_midStream)
+            break;
+          zs->next_in = eof ? Z_NULL : reinterpret_cast<Bytef *>(const_cast<char *>(_raw + _rawPos));
+          zs->avail_in = eof ? 0 : static_cast<uInt>(_rawLength - _rawPos);
+
+          uInt room = zs->avail_out;
+          int rc = inflate(zs, Z_NO_FLUSH);
+          if (!eof)
+            _rawPos = _rawLength - zs->avail_in;
+          if (rc == Z_STREAM_END)
+          {
+            // another member may follow (gzip files can be concatenated)
+            _midStream = false;
+            inflateReset(zs);
+          }
+          else if (rc == Z_OK || rc == Z_BUF_ERROR)
+          {
+            _midStream = true;
+            if (eof && zs->avail_out == room)
+              throw Error(std::string("Truncated gzip data in ").append(_file));
+          }
+          else
+            throw Error(std::string("Corrupt gzip data in ").append(_file));
+      }
+      _out.resize(_blockSize - zs->avail_out);
+      return !_out.empty();
+#else
+      return false;
+#endif
+  }
+
+  // streaming zstd: fill one output block, pulling raw blocks as needed
+  bool BlockReader::decompressStream(void)
+  {
+#ifdef CSV_HAVE_ZSTD
+      ZSTD_DCtx *dctx = static_cast<ZSTD_DCtx *>(_stream);
+      _out.resize(_blockSize);
+      ZSTD_outBuffer out = { &_out[0], _blockSize, 0 };
+      while (out.pos < out.size)
+      {
+          bool eof = _rawPos == _rawLength && !pullRaw();
+          if (eof && !_midStream)
+            break;
+          ZSTD_inBuffer in = { eof ? nullptr : _raw, eof ? 0 : _rawLength, eof ? 0 : _rawPos };
+
+          size_t filled = out.pos;
+          size_t rc = ZSTD_decompressStream(dctx, &out, &in);
+          if (ZSTD_isError(rc))
+            throw Error(std::string("Corrupt zstd data in ").append(_file));
+          if (!eof)
+            _rawPos = in.pos;
+          _midStream = rc != 0; // 0 once a frame is fully decoded and flushed
+          if (eof && _midStream && out.pos == filled)
+            throw Error(std::string("Truncated zstd data in ").append(_file));
+      }
+      _out.resize(out.pos);
+      return !_out.empty();
+#else
+      return false;
+#endif
+  }
+
+  // parallel formats: gather a batch of whole blocks, decode them on worker
+  // threads. A block that cannot be decoded on its own ends the batch, and
+  // the streaming decoder takes over from it
+  bool BlockReader::decodeBatch(void)
+  {
+      std::vector<Unit> units;
+      std::vector<size_t> outStart;
+      size_t consumed = 0;
+      size_t total = 0;
+      bool eof = false;
+      bool serial = false;
+      while (units.size() < PARALLEL_UNITS && total < PARALLEL_BATCH_BLOCKS * _blockSize)
+      {
+          Unit unit;
+          UnitScan scan = nextUnit(_carry.data() + consumed, _carry.size() - consumed, unit);
+          if (scan == eWHOLE)
+          {
+            unit.offset = consumed;
+            consumed += unit.size;
+            units.push_back(unit);
+            outStart.push_back(total);
+            total += unit.decodedSize;
+            continue;
+          }
+          if (scan == eSERIAL)
+          {
+            serial = true;
+            break;
+          }
+          if (eof)
+            break;
+          // not a whole block yet, take in the rest of the current raw block
+          if (_rawPos == _rawLength && !pullRaw())
+          {
+            eof = true;
+            continue;
+          }
+          _carry.append(_raw + _rawPos, _rawLength - _rawPos);
+          _rawPos = _rawLength;
+      }
+      if (units.empty() && !serial)
+      {
+        if (!_carry.empty())
+          throw Error(std::string("Truncated compressed data in ").append(_file));
+        _out.clear();
+        return false;
+      }
+      _out.resize(total);
+
+      std::atomic<size_t> nextIndex(0);
+      std::mutex failureLock;
+      std::exception_ptr failure;
+      auto worker = [&]() {
+          for (size_t i = nextIndex++; i < units.size(); i = nextIndex++)
+          {
+              try
+              {
+                decodeUnit(_carry.data(), units[i], &_out[0] + outStart[i]);
+              }
+              catch (...)
+              {
+                std::lock_guard<std::mutex> guard(failureLock);
+                if (!failure)
+                  failure = std::current_exception();
+              }
+          }
+      };
+      std::vector<std::thread> workers;
+      size_t workerCount = std::min<size_t>(units.size(), std::max(1u, std::thread::hardware_concurrency()));
+      for (size_t i = 1; i < workerCount; ++i)
+        workers.emplace_back(worker);
+      worker();
+      for (std::thread &thread : workers)
+        thread.join();
+      if (failure)
+        std::rethrow_exception(failure);
+
+      _carry.erase(0, consumed);
+      if (serial)
+      {
+        // every raw byte not decoded yet is in the carry: stream from it
+        startStream();
+        _raw = _carry.data();
+        _rawLength = _carry.size();
+        _rawPos = 0;
+      }
+      return true;
+  }
+
+  // the whole block starting at data, once it is complete; a gzip member
+  // that is not a BGZF block, or a block whose header gives no usable
+  // decoded size, is left to the streaming decoder
+  BlockReader::UnitScan BlockReader::nextUnit(const char *data, size_t length, Unit &unit) const
+  {
+#ifdef CSV_HAVE_ZLIB
+      if (_compression == eGZIP)
+      {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+        if (length < 18)
+          return ePARTIAL; // any whole gzip member is longer
+        if (!isBgzf(p, length))
+          return eSERIAL;
+        unit.size = (p[16] | (p[17] << 8)) + 1;
+        if (length < unit.size)
+          return ePARTIAL;
+        // ISIZE, the last four bytes of the member
+        const unsigned char *isize = p + unit.size - 4;
+        unit.decodedSize = isize[0] | (isize[1] << 8) | (isize[2] << 16)
+                           | (static_cast<size_t>(isize[3]) << 24);
+        return unit.decodedSize <= BGZF_MAX_BLOCK ? eWHOLE : eSERIAL;
+      }
+#endif
+#ifdef CSV_HAVE_ZSTD
+      if (_compression == eZSTD)
+      {
+        size_t size = ZSTD_findFrameCompressedSize(data, length);
+        if (ZSTD_isError(size))
+        {
+          if (ZSTD_getErrorCode(size) == ZSTD_error_srcSize_wrong)
+            return ePARTIAL;
+          throw Error(std::string("Corrupt zstd data in ").append(_file));
+        }
+        unsigned long long decoded = ZSTD_getFrameContentSize(data, size);
+        if (decoded == ZSTD_CONTENTSIZE_UNKNOWN || decoded == ZSTD_CONTENTSIZE_ERROR
+            || decoded > PARALLEL_FRAME_BLOCKS * _blockSize)
+          return eSERIAL;
+        unit.size = size;
+        unit.decodedSize = decoded;
+        return eWHOLE;
+      }
+#endif
+      (void)data;
+      (void)length;
+      (void)unit;
+      return ePARTIAL;
+  }
+
+  // decode one whole block into its exact slot of the output
+  void BlockReader::decodeUnit(const char *data, const Unit &unit, char *out) const
+  {
+      if (unit.decodedSize == 0)
+        return; // BGZF end-of-file marker, zstd skippable frame
+#ifdef CSV_HAVE_ZLIB
+      if (_compression == eGZIP)
+      {
+        z_stream zs = z_stream();
+        if (inflateInit2(&zs, 15 + 16) != Z_OK)
+          throw Error(std::string("Failed to start gzip decoding of ").append(_file));
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data + unit.offset));
+        zs.avail_in = static_cast<uInt>(unit.size);
+        zs.next_out = reinterpret_cast<Bytef *>(out);
+        zs.avail_out = static_cast<uInt>(unit.decodedSize);
+        int rc = inflate(&zs, Z_FINISH);
+        inflateEnd(&zs);
+        if (rc != Z_STREAM_END || zs.avail_out != 0)
+          throw Error(std::string("Corrupt gzip data in ").append(_file));
+      }
+#endif
+#ifdef CSV_HAVE_ZSTD
+      if (_compression == eZSTD)
+      {
+        size_t rc = ZSTD_decompress(out, unit.decodedSize, data + unit.offset, unit.size);
+        if (ZSTD_isError(rc) || rc != unit.decodedSize)
+          throw Error(std::string("Corrupt zstd data in ").append(_file));
+      }
+#endif
+      (void)data;
+      (void)out;
+  }
+}
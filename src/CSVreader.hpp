@@ -0,0 +1,161 @@
+#ifndef     _CSVREADER_HPP_
+# define    _CSVREADER_HPP_
+
+# include <cstddef>
+# include <string>
+# include <vector>
+
+namespace csv
+{
+    /*
+    ** Reads a whole file as a sequence of large blocks, handed out in file
+    ** order. On Linux an io_uring keeps several block reads in flight at
+    ** once, so the disk is busy while the caller works on the previous
+    ** block; when io_uring is unavailable (old kernel, seccomp, other
+    ** platforms) blocks are read one at a time with pread. Pipes and
+    ** devices are read sequentially; they have no fileSize until the
+    ** last block and no readAt.
+    */
+    class FileReader
+    {
+
+    public:
+        FileReader(const std::string &file, size_t blockSize = 1 << 20,
+                   unsigned int depth = 4, bool useIoUring = true);
+        ~FileReader(void);
+
+        FileReader(const FileReader &) = delete;
+        FileReader &operator=(const FileReader &) = delete;
+
+    public:
+        bool next(const char *&data, size_t &length);
+        size_t fileSize(void) const;
+        long long modified(void) const; // nanoseconds since the epoch
+        long long changed(void) const;  // inode change time, the same way
+        unsigned long long inode(void) const;
+        bool isRegular(void) const;
+        bool usesIoUring(void) const;
+        // blocking read of up to length bytes at offset, apart from next()
+        size_t readAt(char *buffer, size_t length, size_t offset) const;
+
+    private:
+        struct Slot
+        {
+            char *buffer = nullptr;
+            size_t offset = 0;  // file offset this slot was submitted for
+            size_t length = 0;  // bytes read once ready
+            bool busy = false;  // owned by the kernel
+            bool ready = false; // completed, waiting to be handed out
+        };
+
+        size_t readStream(char *buffer, size_t length);
+        void release(void);
+        bool setupRing(unsigned int depth);
+        void teardownRing(void);
+        void submit(Slot &slot);
+        void reap(void);
+
+    private:
+        std::string _file;
+        int _fd;
+        bool _regular;
+        size_t _fileSize;
+        long long _modified;
+        long long _changed;
+        unsigned long long _inode;
+        const size_t _blockSize;
+        size_t _nextSubmit;  // next file offset to request
+        size_t _nextDeliver; // next file offset to hand out
+        std::vector<Slot> _slots;
+        Slot *_lent;         // slot handed to the caller by the last next()
+
+        // io_uring state, unused on the pread path
+        int _ringFd;
+        void *_sqRing;
+        size_t _sqRingSize;
+        void *_cqRing;
+        size_t _cqRingSize;
+        void *_sqes;
+        size_t _sqesSize;
+        unsigned int *_sqTail;
+        unsigned int *_sqMask;
+        unsigned int *_sqArray;
+        unsigned int *_cqHead;
+        unsigned int *_cqTail;
+        unsigned int *_cqMask;
+        void *_cqes;
+    };
+
+    enum Compression {
+        eNONE = 0,
+        eGZIP = 1,
+        eZSTD = 2
+    };
+
+    /*
+    ** Hands out the decoded bytes of a CSV file in blocks. The format is
+    ** detected from the first bytes: plain files pass straight through a
+    ** FileReader, gzip and zstd files are decompressed on the fly as the
+    ** compressed blocks arrive, so no decompressed copy ever hits the disk.
+    ** Files made of independent blocks (BGZF gzip, multi-frame zstd) are
+    ** decompressed a batch of blocks at a time, one block per thread.
+    */
+    class BlockReader
+    {
+
+    public:
+        BlockReader(const std::string &file, size_t blockSize = 1 << 20);
+        ~BlockReader(void);
+
+        BlockReader(const BlockReader &) = delete;
+        BlockReader &operator=(const BlockReader &) = delete;
+
+    public:
+        bool next(const char *&data, size_t &length);
+        Compression compression(void) const;
+        bool isParallel(void) const;
+
+    private:
+        // one independently compressed block of a parallel file
+        struct Unit
+        {
+            size_t offset;
+            size_t size;
+            size_t decodedSize;
+        };
+
+        // what nextUnit found at the start of the carried bytes
+        enum UnitScan {
+            ePARTIAL, // not a whole block yet
+            eWHOLE,   // a block that can be decoded on its own
+            eSERIAL   // a block to leave to the streaming decoder
+        };
+
+        bool pullRaw(void);
+        void startStream(void);
+        bool inflateStream(void);
+        bool decompressStream(void);
+        bool decodeBatch(void);
+        UnitScan nextUnit(const char *data, size_t length, Unit &unit) const;
+        void decodeUnit(const char *data, const Unit &unit, char *out) const;
+
+    private:
+        std::string _file;
+        FileReader _source;
+        const size_t _blockSize;
+        Compression _compression;
+        bool _parallel;
+
+        const char *_peek;   // first raw block, read to detect the format
+        size_t _peekLength;
+        const char *_raw;    // current raw block
+        size_t _rawLength;
+        size_t _rawPos;      // bytes of it already consumed
+        std::string _carry;  // raw bytes of incomplete parallel blocks
+        std::string _out;    // decoded bytes handed out by next()
+        bool _midStream;     // a compressed stream was started but not finished
+        void *_stream;       // z_stream or ZSTD_DCtx
+    };
+}
+
+#endif /*!_CSVREADER_HPP_*/
@@ -0,0 +1,146 @@
+#ifndef     _CSVSCHEMA_HPP_
+# define    _CSVSCHEMA_HPP_
+
+# include <array>
+# include <charconv>
+# include <cstddef>
+# include <string>
+# include <string_view>
+# include <tuple>
+# include <type_traits>
+# include <vector>
+# include "CSVparser.hpp"
+
+namespace csv
+{
+    // a header name or field without surrounding blanks (and the \r of a CRLF line)
+    inline std::string_view trimSpaces(std::string_view text)
+    {
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos)
+          return std::string_view();
+        return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    }
+
+    // default conversions, used by bindings that do not name their own
+    inline void convertField(std::string_view field, std::string &out)
+    {
+        out.assign(field.data(), field.size());
+    }
+
+    // numbers are read with surrounding blanks ignored, 0 when unreadable
+    template <typename T>
+    requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+    void convertField(std::string_view field, T &out)
+    {
+        field = trimSpaces(field);
+        out = T();
+        std::from_chars(field.data(), field.data() + field.size(), out);
+    }
+
+    /*
+    ** One struct member bound to a CSV column. The column is found by its
+    ** header name, or by any alias for exports that renamed it; names
+    ** are compared with surrounding blanks trimmed, so "Fund" also
+    ** matches a "Fund " header. convert turns the raw field into the
+    ** member.
+    */
+    template <typename Record, typename T, size_t N>
+    struct Binding
+    {
+        T Record::*member;
+        std::array<std::string_view, N> names;
+        void (*convert)(std::string_view, T &);
+    };
+
+    // bind member to the first column called one of names
+    template <typename Record, typename T, typename... Names>
+    constexpr Binding<Record, T, sizeof...(Names)> bind(T Record::*member, Names... names)
+    {
+        return {member, {std::string_view(names)...},
+                static_cast<void (*)(std::string_view, T &)>(&convertField)};
+    }
+
+    // same, converting the field with convert
+    template <typename Record, typename T, typename... Names>
+    constexpr Binding<Record, T, sizeof...(Names)> bind(T Record::*member,
+                                                        void (*convert)(std::string_view, T &),
+                                                        Names... names)
+    {
+        return {member, {std::string_view(names)...}, convert};
+    }
+
+    /*
+    ** A compile-time description of how the columns of a CSV file map to
+    ** the members of Record, ex
+    **
+    **   constexpr auto schema = csv::Schema(csv::bind(&Bid::bidId, "Auction ID"),
+    **                                       csv::bind(&Bid::fund, "Fund"));
+    **
+    ** resolve() looks every binding up in a file's header once; after
+    ** that assign() converts the bound fields of each split row straight
+    ** into the struct. Columns nothing is bound to are skipped.
+    */
+    template <typename Record, typename... Bindings>
+    class Schema
+    {
+
+    public:
+        // a schema resolved against one header
+        struct Layout
+        {
+            std::array<unsigned int, sizeof...(Bindings)> positions;
+            size_t columns; // fields every record must have
+        };
+
+    public:
+        constexpr Schema(Bindings... bindings)
+          : _bindings(bindings...)
+        {
+        }
+
+        // find every bound column in header; a missing one is an Error
+        Layout resolve(const std::vector<std::string> &header) const
+        {
+            Layout layout;
+            layout.columns = header.size();
+            unsigned int binding = 0;
+            std::apply([&](const auto &... each) {
+                ((layout.positions[binding++] = find(header, each.names)), ...);
+            }, _bindings);
+            return layout;
+        }
+
+        // fill the bound members of record from an already split row
+        template <typename Fields>
+        void assign(const Fields &fields, const Layout &layout, Record &record) const
+        {
+            if (fields.size() != layout.columns)
+              throw Error("corrupted data !");
+            unsigned int binding = 0;
+            std::apply([&](const auto &... each) {
+                ((each.convert(std::string_view(fields[layout.positions[binding++]]), record.*each.member)), ...);
+            }, _bindings);
+        }
+
+    private:
+        template <size_t N>
+        static unsigned int find(const std::vector<std::string> &header,
+                                 const std::array<std::string_view, N> &names)
+        {
+            for (std::string_view name : names)
+              for (size_t column = 0; column < header.size(); column++)
+                if (trimSpaces(header[column]) == name)
+                  return static_cast<unsigned int>(column);
+            throw Error(std::string("missing column ").append(names[0]));
+        }
+
+    private:
+        std::tuple<Bindings...> _bindings;
+    };
+
+    template <typename Record, typename... T, size_t... N>
+    Schema(Binding<Record, T, N>...) -> Schema<Record, Binding<Record, T, N>...>;
+}
+
+#endif /*!_CSVSCHEMA_HPP_*/
@@ -0,0 +1,425 @@
+#ifndef     _HASHPOLICY_HPP_
+# define    _HASHPOLICY_HPP_
+
+# include <array>
+# include <cstddef>
+# include <cstdint>
+# include <cstring>
+# include <functional>
+# include <string_view>
+# if defined(__x86_64__) || defined(__i386__)
+#  include <nmmintrin.h>
+# elif defined(__ARM_FEATURE_CRC32)
+#  include <arm_acle.h>
+# endif
+
+/**
+ * Hash policies for HashTable.
+ *
+ * A policy is a stateless functor turning a key into a 64-bit hash. The
+ * table keeps the whole hash in its nodes and picks the bucket from its
+ * low bits by masking (the table size is a power of two), so a policy
+ * must mix well into the low bits; IdentityHash is the deliberate
+ * exception for dense numeric ids. Every policy has a name for reports.
+ *
+ * The byte readers below assume a little-endian host (x86-64, AArch64).
+ */
+
+inline std::uint64_t hashRead64(const char *p)
+{
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline std::uint64_t hashRead32(const char *p)
+{
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// 64x64 -> 128 bit multiply, returned as (low, high)
+inline void hashMultiply(std::uint64_t &a, std::uint64_t &b)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    a = static_cast<std::uint64_t>(product);
+    b = static_cast<std::uint64_t>(product >> 64);
+#else
+    std::uint64_t aLow = a & 0xFFFFFFFFu, aHigh = a >> 32;
+    std::uint64_t bLow = b & 0xFFFFFFFFu, bHigh = b >> 32;
+    std::uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh;
+    std::uint64_t highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+    std::uint64_t cross = (lowLow >> 32) + (lowHigh & 0xFFFFFFFFu) + highLow;
+    a = (cross << 32) | (lowLow & 0xFFFFFFFFu);
+    b = highHigh + (lowHigh >> 32) + (cross >> 32);
+#endif
+}
+
+// low ^ high of the 128-bit product
+inline std::uint64_t hashMultiplyFold(std::uint64_t a, std::uint64_t b)
+{
+    hashMultiply(a, b);
+    return a ^ b;
+}
+
+/**
+ * The standard library hash (murmur-style in libstdc++); the baseline
+ * the other policies are measured against.
+ */
+struct StdHash
+{
+    static constexpr const char *name = "std::hash";
+
+    std::size_t operator()(std::string_view key) const noexcept
+    {
+        return std::hash<std::string_view>{}(key);
+    }
+};
+
+/**
+ * wyhash (final4): one or two 128-bit multiplies for keys up to 16
+ * bytes, which covers every bidId, and 48 bytes per round beyond that.
+ */
+struct WyHash
+{
+    static constexpr const char *name = "wyhash";
+
+    std::size_t operator()(std::string_view key) const noexcept
+    {
+        static constexpr std::uint64_t secret[4] = {
+            0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+            0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+        const char *p = key.data();
+        std::size_t len = key.size();
+        std::uint64_t seed = hashMultiplyFold(secret[0], secret[1]);
+        std::uint64_t a, b;
+        if (len <= 16)
+        {
+            if (len >= 4)
+            {
+                std::size_t middle = (len >> 3) << 2;
+                a = (hashRead32(p) << 32) | hashRead32(p + middle);
+                b = (hashRead32(p + len - 4) << 32) | hashRead32(p + len - 4 - middle);
+            }
+            else if (len > 0)
+            {
+                const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+                a = (static_cast<std::uint64_t>(u[0]) << 16) |
+                    (static_cast<std::uint64_t>(u[len >> 1]) << 8) | u[len - 1];
+                b = 0;
+            }
+            else
+                a = b = 0;
+        }
+        else
+        {
+            std::size_t i = len;
+            if (i >= 48)
+            {
+                std::uint64_t see1 = seed, see2 = seed;
+                do
+                {
+                    seed = hashMultiplyFold(hashRead64(p) ^ secret[1], hashRead64(p + 8) ^ seed);
+                    see1 = hashMultiplyFold(hashRead64(p + 16) ^ secret[2], hashRead64(p + 24) ^ see1);
+                    see2 = hashMultiplyFold(hashRead64(p + 32) ^ secret[3], hashRead64(p + 40) ^ see2);
+                    p += 48;
+                    i -= 48;
+                } while (i >= 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16)
+            {
+                seed = hashMultiplyFold(hashRead64(p) ^ secret[1], hashRead64(p + 8) ^ seed);
+                i -= 16;
+                p += 16;
+            }
+            a = hashRead64(p + i - 16);
+            b = hashRead64(p + i - 8);
+        }
+        a ^= secret[1];
+        b ^= seed;
+        hashMultiply(a, b);
+        return hashMultiplyFold(a ^ secret[0] ^ len, b ^ secret[1]);
+    }
+};
+
+/**
+ * XXH3 64-bit with the default secret and seed 0; gives the same values
+ * as XXH3_64bits() from xxHash 0.8. Short keys take a dedicated path per
+ * length class, long keys (over 240 bytes) the striped scalar loop.
+ */
+struct Xxh3Hash
+{
+    static constexpr const char *name = "xxh3";
+
+    std::size_t operator()(std::string_view key) const noexcept
+    {
+        const char *p = key.data();
+        std::size_t len = key.size();
+        if (len <= 16)
+        {
+            if (len > 8)
+            {
+                std::uint64_t low = hashRead64(p) ^ (hashRead64(secret + 24) ^ hashRead64(secret + 32));
+                std::uint64_t high = hashRead64(p + len - 8) ^ (hashRead64(secret + 40) ^ hashRead64(secret + 48));
+                return avalanche(len + __builtin_bswap64(low) + high + hashMultiplyFold(low, high));
+            }
+            if (len >= 4)
+            {
+                std::uint64_t input = hashRead32(p + len - 4) + (hashRead32(p) << 32);
+                std::uint64_t keyed = input ^ (hashRead64(secret + 8) ^ hashRead64(secret + 16));
+                keyed ^= rotl(keyed, 49) ^ rotl(keyed, 24);
+                keyed *= 0x9FB21C651E98DF25ull;
+                keyed ^= (keyed >> 35) + len;
+                keyed *= 0x9FB21C651E98DF25ull;
+                return keyed ^ (keyed >> 28);
+            }
+            if (len > 0)
+            {
+                const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+                std::uint32_t combined = (static_cast<std::uint32_t>(u[0]) << 16) |
+                                         (static_cast<std::uint32_t>(u[len >> 1]) << 24) |
+                                         u[len - 1] | (static_cast<std::uint32_t>(len) << 8);
+                return avalanche64(combined ^ (hashRead32(secret) ^ hashRead32(secret + 4)));
+            }
+            return avalanche64(hashRead64(secret + 56) ^ hashRead64(secret + 64));
+        }
+        if (len <= 128)
+        {
+            std::uint64_t acc = len * PRIME64_1;
+            if (len > 32)
+            {
+                if (len > 64)
+                {
+                    if (len > 96)
+                    {
+                        acc += mix16(p + 48, secret + 96);
+                        acc += mix16(p + len - 64, secret + 112);
+                    }
+                    acc += mix16(p + 32, secret + 64);
+                    acc += mix16(p + len - 48, secret + 80);
+                }
+                acc += mix16(p + 16, secret + 32);
+                acc += mix16(p + len - 32, secret + 48);
+            }
+            acc += mix16(p, secret);
+            acc += mix16(p + len - 16, secret + 16);
+            return avalanche(acc);
+        }
+        if (len <= 240)
+        {
+            std::uint64_t acc = len * PRIME64_1;
+            for (std::size_t i = 0; i < 8; ++i)
+                acc += mix16(p + 16 * i, secret + 16 * i);
+            std::uint64_t accEnd = mix16(p + len - 16, secret + 136 - 17);
+            acc = avalanche(acc);
+            for (std::size_t i = 8; i < len / 16; ++i)
+                accEnd += mix16(p + 16 * i, secret + 16 * (i - 8) + 3);
+            return avalanche(acc + accEnd);
+        }
+        return hashLong(p, len);
+    }
+
+private:
+    static constexpr std::uint64_t PRIME32_1 = 0x9E3779B1u;
+    static constexpr std::uint64_t PRIME32_2 = 0x85EBCA77u;
+    static constexpr std::uint64_t PRIME32_3 = 0xC2B2AE3Du;
+    static constexpr std::uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+    static constexpr std::uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr std::uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+    static constexpr std::uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+    static constexpr std::uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+    static constexpr std::size_t SECRET_SIZE = 192;
+    static constexpr std::size_t STRIPE = 64;
+
+    static constexpr char secret[SECRET_SIZE] = {
+        '\xb8', '\xfe', '\x6c', '\x39', '\x23', '\xa4', '\x4b', '\xbe', '\x7c', '\x01', '\x81', '\x2c', '\xf7', '\x21', '\xad', '\x1c',
+        '\xde', '\xd4', '\x6d', '\xe9', '\x83', '\x90', '\x97', '\xdb', '\x72', '\x40', '\xa4', '\xa4', '\xb7', '\xb3', '\x67', '\x1f',
+        '\xcb', '\x79', '\xe6', '\x4e', '\xcc', '\xc0', '\xe5', '\x78', '\x82', '\x5a', '\xd0', '\x7d', '\xcc', '\xff', '\x72', '\x21',
+        '\xb8', '\x08', '\x46', '\x74', '\xf7', '\x43', '\x24', '\x8e', '\xe0', '\x35', '\x90', '\xe6', '\x81', '\x3a', '\x26', '\x4c',
+        '\x3c', '\x28', '\x52', '\xbb', '\x91', '\xc3', '\x00', '\xcb', '\x88', '\xd0', '\x65', '\x8b', '\x1b', '\x53', '\x2e', '\xa3',
+        '\x71', '\x64', '\x48', '\x97', '\xa2', '\x0d', '\xf9', '\x4e', '\x38', '\x19', '\xef', '\x46', '\xa9', '\xde', '\xac', '\xd8',
+        '\xa8', '\xfa', '\x76', '\x3f', '\xe3', '\x9c', '\x34', '\x3f', '\xf9', '\xdc', '\xbb', '\xc7', '\xc7', '\x0b', '\x4f', '\x1d',
+        '\x8a', '\x51', '\xe0', '\x4b', '\xcd', '\xb4', '\x59', '\x31', '\xc8', '\x9f', '\x7e', '\xc9', '\xd9', '\x78', '\x73', '\x64',
+        '\xea', '\xc5', '\xac', '\x83', '\x34', '\xd3', '\xeb', '\xc3', '\xc5', '\x81', '\xa0', '\xff', '\xfa', '\x13', '\x63', '\xeb',
+        '\x17', '\x0d', '\xdd', '\x51', '\xb7', '\xf0', '\xda', '\x49', '\xd3', '\x16', '\x55', '\x26', '\x29', '\xd4', '\x68', '\x9e',
+        '\x2b', '\x16', '\xbe', '\x58', '\x7d', '\x47', '\xa1', '\xfc', '\x8f', '\xf8', '\xb8', '\xd1', '\x7a', '\xd0', '\x31', '\xce',
+        '\x45', '\xcb', '\x3a', '\x8f', '\x95', '\x16', '\x04', '\x28', '\xaf', '\xd7', '\xfb', '\xca', '\xbb', '\x4b', '\x40', '\x7e'};
+
+    static std::uint64_t rotl(std::uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static std::uint64_t avalanche(std::uint64_t h)
+    {
+        h ^= h >> 37;
+        h *= 0x165667919E3779F9ull;
+        return h ^ (h >> 32);
+    }
+
+    static std::uint64_t avalanche64(std::uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= PRIME64_2;
+        h ^= h >> 29;
+        h *= PRIME64_3;
+        return h ^ (h >> 32);
+    }
+
+    static std::uint64_t mix16(const char *p, const char *key)
+    {
+        return hashMultiplyFold(hashRead64(p) ^ hashRead64(key), hashRead64(p + 8) ^ hashRead64(key + 8));
+    }
+
+    static void accumulate(std::uint64_t *acc, const char *p, const char *key)
+    {
+        for (std::size_t lane = 0; lane < 8; ++lane)
+        {
+            std::uint64_t value = hashRead64(p + lane * 8);
+            std::uint64_t keyed = value ^ hashRead64(key + lane * 8);
+            acc[lane ^ 1] += value;
+            acc[lane] += (keyed & 0xFFFFFFFFu) * (keyed >> 32);
+        }
+    }
+
+    static std::uint64_t hashLong(const char *p, std::size_t len)
+    {
+        std::uint64_t acc[8] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                                PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+        const std::size_t stripesPerBlock = (SECRET_SIZE - STRIPE) / 8;
+        const std::size_t blockLength = STRIPE * stripesPerBlock;
+        const std::size_t blocks = (len - 1) / blockLength;
+        for (std::size_t n = 0; n < blocks; ++n)
+        {
+            for (std::size_t s = 0; s < stripesPerBlock; ++s)
+                accumulate(acc, p + n * blockLength + s * STRIPE, secret + s * 8);
+            for (std::size_t lane = 0; lane < 8; ++lane)
+            {
+                std::uint64_t scrambled = acc[lane] ^ (acc[lane] >> 47);
+                scrambled ^= hashRead64(secret + SECRET_SIZE - STRIPE + lane * 8);
+                acc[lane] = scrambled * PRIME32_1;
+            }
+        }
+        const std::size_t stripes = ((len - 1) - blockLength * blocks) / STRIPE;
+        for (std::size_t s = 0; s < stripes; ++s)
+            accumulate(acc, p + blocks * blockLength + s * STRIPE, secret + s * 8);
+        accumulate(acc, p + len - STRIPE, secret + SECRET_SIZE - STRIPE - 7);
+
+        std::uint64_t result = len * PRIME64_1;
+        for (std::size_t i = 0; i < 4; ++i)
+            result += hashMultiplyFold(acc[2 * i] ^ hashRead64(secret + 11 + 16 * i),
+                                       acc[2 * i + 1] ^ hashRead64(secret + 11 + 16 * i + 8));
+        return avalanche(result);
+    }
+};
+
+/**
+ * CRC32-C (Castagnoli) of the key. Uses the SSE4.2 / ARMv8 crc32c
+ * instructions (8 bytes per instruction) when the CPU has them, checked
+ * once at startup on x86 so the default build benefits too, and a table
+ * driven byte loop otherwise. Only 32 bits wide, so two different ids
+ * share a stored hash once in 2^32 and take a string compare.
+ */
+struct Crc32cHash
+{
+    static constexpr const char *name = "crc32c";
+
+    std::size_t operator()(std::string_view key) const noexcept
+    {
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+        return hardware(key.data(), key.size());
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+        return hasHardware() ? hardware(key.data(), key.size()) : software(key.data(), key.size());
+#else
+        return software(key.data(), key.size());
+#endif
+    }
+
+    static std::uint32_t software(const char *p, std::size_t len)
+    {
+        static constexpr std::array<std::uint32_t, 256> table = [] {
+            std::array<std::uint32_t, 256> entries{};
+            for (std::uint32_t i = 0; i < 256; ++i)
+            {
+                std::uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit)
+                    crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+                entries[i] = crc;
+            }
+            return entries;
+        }();
+        std::uint32_t crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < len; ++i)
+            crc = table[(crc ^ static_cast<unsigned char>(p[i])) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+#if defined(__x86_64__) || defined(__i386__) || defined(__ARM_FEATURE_CRC32)
+# if !defined(__SSE4_2__) && !defined(__ARM_FEATURE_CRC32)
+    __attribute__((target("sse4.2")))
+# endif
+    static std::uint32_t hardware(const char *p, std::size_t len)
+    {
+        std::uint32_t crc = 0xFFFFFFFFu;
+# if defined(__ARM_FEATURE_CRC32)
+        for (; len >= 8; p += 8, len -= 8)
+            crc = __crc32cd(crc, hashRead64(p));
+        for (; len > 0; ++p, --len)
+            crc = __crc32cb(crc, static_cast<unsigned char>(*p));
+# elif defined(__x86_64__)
+        for (; len >= 8; p += 8, len -= 8)
+            crc = static_cast<std::uint32_t>(_mm_crc32_u64(crc, hashRead64(p)));
+        for (; len > 0; ++p, --len)
+            crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*p));
+# else
+        for (; len >= 4; p += 4, len -= 4)
+            crc = _mm_crc32_u32(crc, static_cast<std::uint32_t>(hashRead32(p)));
+        for (; len > 0; ++p, --len)
+            crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*p));
+# endif
+        return ~crc;
+    }
+#endif
+
+#if !defined(__SSE4_2__) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    static bool hasHardware()
+    {
+        static const bool supported = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse4.2") != 0;
+        }();
+        return supported;
+    }
+#endif
+};
+
+/**
+ * Identity for integer ids: a key of 1 to 19 decimal digits hashes to
+ * its value, so dense numeric bidIds land in consecutive buckets with no
+ * collisions at all. Any other key falls back to wyhash. Ids that are
+ * all multiples of a power of two would pile into few buckets; the
+ * mixing policies are the safe choice for ids of unknown shape.
+ */
+struct IdentityHash
+{
+    static constexpr const char *name = "identity";
+
+    std::size_t operator()(std::string_view key) const noexcept
+    {
+        if (key.empty() || key.size() > 19)
+            return WyHash{}(key);
+        std::uint64_t value = 0;
+        for (char c : key)
+        {
+            if (c < '0' || c > '9')
+                return WyHash{}(key);
+            value = value * 10 + static_cast<std::uint64_t>(c - '0');
+        }
+        return value;
+    }
+};
+
+#endif /*!_HASHPOLICY_HPP_*/
@@ -4,14 +4,42 @@
 //============================================================================
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
 #include <climits>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <string> // atoi
+#include <string_view>
+#include <thread>
 #include <time.h>
+#include <unordered_map>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+#include "Aggregate.hpp"
 #include "CSVparser.hpp"
+#include "CSVschema.hpp"
+#include "HashPolicy.hpp"
+#include "HashTable.hpp"
+#include "SpscRing.hpp"
 
 using namespace std;
 
@@ -44,434 +72,2052 @@ const std::string Color::BRIGHT_GREEN = "[1;32m";
 const std::string Color::BRIGHT_RED = "[1;31m";
 const std::string Color::MAGENTA = "[1;35m";
 
-const unsigned int DEFAULT_SIZE = 179;
+// a power of two: buckets are picked by masking the hash, not by %
+const unsigned int DEFAULT_SIZE = 256;
+
+// shards are padded to this so two owner threads never share a line
+const size_t CACHE_LINE_SIZE = 64;
+
+// pending commands each shard owner can buffer before callers block
+const size_t MAILBOX_SIZE = 1024;
+
+// sorted entries per fence pointer in a range index
+const size_t FENCE_STRIDE = 64;
 
 // forward declarations
 double strToDouble(string str, char ch);
+int parseDate(const string& date);
+struct Bid;
+void printBidTableHeader(unsigned int bidCount, const string& title = "All Bids");
+void printBidTableRow(const Bid& bid);
+void printBidTableFooter();
 
 // define a structure to hold bid information
 struct Bid {
     string bidId; // unique identifier
     string title;
     string fund;
+    string department;
     double amount;
+    int closeDate; // yyyymmdd, 0 when unknown
 
     Bid() {
         amount = 0.0;
+        closeDate = 0;
     }
 };
 
+// low-cardinality columns a report can group by
+enum class GroupBy {
+    NONE,
+    FUND,
+    DEPARTMENT
+};
+
+/**
+ * Column snapshot of the bid amounts for aggregation, laid out group by
+ * group: amount[groupStart[g] .. groupStart[g + 1]) belongs to group
+ * groupNames[g]. Without grouping there is a single, unnamed group.
+ */
+struct BidColumns {
+    vector<double> amount;
+    vector<size_t> groupStart;
+    vector<string> groupNames;
+};
+
 //============================================================================
 // Hash Table class definition
 //============================================================================
 
 /**
  * Define a class containing data members and methods to
- * implement a hash table with chaining.
+ * implement a hash table of bids keyed by bidId.
+ *
+ * The bids themselves live in a HashTable<string, Bid> (HashTable.hpp)
+ * hashed with WyHash (HashPolicy.hpp); this class keeps the fund,
+ * department and range indexes in step with it. A stored bid keeps its
+ * slot in the table until it is removed (rehashing and Remove only
+ * relink nodes), so the indexes refer to bids by slot, their payload
+ * index.
  **/
-class HashTable {
+class BidTable {
 private:
-    // Define structures to hold bids
-    struct Node {
-        Bid bid;
-        unsigned int key;
-        Node *next;
+    using Table = HashTable<string, Bid, WyHash, std::equal_to<>>;
+
+    Table table;
+    // where a bid sits in one secondary index: group id and position
+    // in that group's posting list
+    struct IndexSlot {
+        unsigned int group = UINT_MAX;
+        unsigned int pos = 0;
+    };
 
-        // default constructor
-        Node() {
-            key = UINT_MAX;
-            next = nullptr;
+    /**
+     * Secondary index over one bid field (fund or department).
+     * Each distinct value is interned once and owns a posting list of
+     * the payload indexes holding it. Every bid's place in its list is
+     * kept by payload index, so add and drop are O(1): drop moves the
+     * last entry into the hole.
+     */
+    class GroupIndex {
+    public:
+        void add(unsigned int payload, const string& value) {
+            auto interned = groupIds.try_emplace(value, static_cast<unsigned int>(postings.size()));
+            if (interned.second) {
+                names.push_back(value);
+                postings.emplace_back();
+            }
+            if (slots.size() <= payload) {
+                slots.resize(payload + 1);
+            }
+            IndexSlot& slot = slots[payload];
+            slot.group = interned.first->second;
+            slot.pos = static_cast<unsigned int>(postings[slot.group].size());
+            postings[slot.group].push_back(payload);
+        }
+
+        void drop(unsigned int payload) {
+            IndexSlot& slot = slots[payload];
+            vector<unsigned int>& posting = postings[slot.group];
+            unsigned int last = posting.back();
+            posting[slot.pos] = last;
+            slots[last].pos = slot.pos;
+            posting.pop_back();
+            slot = IndexSlot();
+        }
+
+        std::span<const unsigned int> find(const string& value) const {
+            auto found = groupIds.find(value);
+            if (found == groupIds.end()) {
+                return {};
+            }
+            return postings[found->second];
         }
 
-        // initialize with a bid
-        Node(Bid aBid) : Node() {
-            bid = aBid;
+        // visit every interned value with its posting list (possibly empty)
+        template <typename Fn>
+        void forEachGroup(Fn fn) const {
+            for (size_t group = 0; group < postings.size(); ++group) {
+                fn(names[group], std::span<const unsigned int>(postings[group]));
+            }
         }
 
-        // initialize with a bid and a key
-        Node(Bid aBid, unsigned int aKey) : Node(aBid) {
-            key = aKey;
+        void clear() {
+            groupIds.clear();
+            names.clear();
+            postings.clear();
+            slots.clear();
         }
+
+    private:
+        unordered_map<string, unsigned int> groupIds;
+        vector<string> names;
+        vector<vector<unsigned int>> postings;
+        vector<IndexSlot> slots; // by payload index
     };
 
-    vector<Node> nodes;
+    GroupIndex fundIndex;
+    GroupIndex departmentIndex;
+
+    /**
+     * Ordered secondary index over one numeric bid field.
+     *
+     * A cache-friendly sorted array of (key, payload) entries, with a fence
+     * key every FENCE_STRIDE entries so a lookup binary searches a small
+     * fence array and then one stride. Updates stay cheap without moving
+     * the big array on every call:
+     *  - inserts go to a small sorted delta buffer,
+     *  - removes mark their entry dead in place (a tombstone),
+     *  - once the delta outgrows sqrt(n), or a quarter of the array is
+     *    dead, both are merged back into one sorted array.
+     * Range scans merge-walk the array and the delta in key order, so
+     * they cost O(log n + k).
+     *
+     * The index is optional: it is only built by the first range query,
+     * and dropped whenever BulkLoad renumbers the payloads.
+     */
+    template <typename Key>
+    class RangeIndex {
+    public:
+        explicit RangeIndex(Key Bid::*field) : field(field) {}
+
+        bool built() const {
+            return isBuilt;
+        }
+
+        void reset() {
+            sorted.clear();
+            fences.clear();
+            delta.clear();
+            deadCount = 0;
+            isBuilt = false;
+        }
+
+        void build(const Table& table) {
+            reset();
+            sorted.reserve(table.size());
+            table.forEachSlot([&](unsigned int payload) {
+                sorted.push_back(Entry{table.value(payload).*field, payload, false});
+            });
+            std::sort(sorted.begin(), sorted.end(), before);
+            rebuildFences();
+            isBuilt = true;
+        }
 
-    unsigned int tableSize = DEFAULT_SIZE;
+        void add(unsigned int payload, const Bid& bid) {
+            if (!isBuilt) return;
+            Entry entry{bid.*field, payload, false};
+            delta.insert(std::upper_bound(delta.begin(), delta.end(), entry, before), entry);
+            if (delta.size() > std::max<size_t>(FENCE_STRIDE, static_cast<size_t>(std::sqrt(sorted.size())))) {
+                merge();
+            }
+        }
+
+        void drop(unsigned int payload, const Bid& bid) {
+            if (!isBuilt) return;
+            Entry entry{bid.*field, payload, false};
+            // each payload has at most one live entry, in the array or in the delta
+            size_t pos = lowerBound(entry);
+            if (pos < sorted.size() && !sorted[pos].dead && sorted[pos].payload == payload && !(entry.key < sorted[pos].key)) {
+                sorted[pos].dead = true;
+                if (++deadCount > sorted.size() / 4) {
+                    merge();
+                }
+                return;
+            }
+            auto found = std::lower_bound(delta.begin(), delta.end(), entry, before);
+            if (found != delta.end() && found->payload == payload) {
+                delta.erase(found);
+            }
+        }
+
+        // visit the payload index of every bid with lo <= key <= hi, in key order
+        template <typename Visitor>
+        void scan(Key lo, Key hi, Visitor visit) const {
+            Entry probe{lo, 0, false};
+            size_t i = lowerBound(probe);
+            auto j = std::lower_bound(delta.begin(), delta.end(), probe, before);
+            while (true) {
+                bool inSorted = i < sorted.size() && !(hi < sorted[i].key);
+                bool inDelta = j != delta.end() && !(hi < j->key);
+                if (!inSorted && !inDelta) break;
+                if (inSorted && (!inDelta || !before(*j, sorted[i]))) {
+                    if (!sorted[i].dead) visit(sorted[i].payload);
+                    ++i;
+                } else {
+                    visit(j->payload);
+                    ++j;
+                }
+            }
+        }
+
+    private:
+        struct Entry {
+            Key key;
+            unsigned int payload;
+            bool dead;
+        };
+
+        // order by key, ties by payload index so every entry has one exact position
+        static bool before(const Entry& a, const Entry& b) {
+            if (a.key < b.key) return true;
+            if (b.key < a.key) return false;
+            return a.payload < b.payload;
+        }
+
+        // first position of the sorted array not before probe
+        size_t lowerBound(const Entry& probe) const {
+            // fences[f] is the key of sorted[f * FENCE_STRIDE]; pick the stride
+            size_t fence = std::lower_bound(fences.begin(), fences.end(), probe.key) - fences.begin();
+            size_t first = (fence == 0) ? 0 : (fence - 1) * FENCE_STRIDE;
+            size_t last = std::min(sorted.size(), fence * FENCE_STRIDE + 1);
+            // equal keys may span several strides, fall back to the tail
+            if (fence < fences.size() && !(probe.key < fences[fence])) {
+                last = sorted.size();
+            }
+            return std::lower_bound(sorted.begin() + first, sorted.begin() + last, probe, before) - sorted.begin();
+        }
+
+        void merge() {
+            vector<Entry> merged;
+            merged.reserve(sorted.size() - deadCount + delta.size());
+            auto live = [](const Entry& entry) { return !entry.dead; };
+            vector<Entry> kept;
+            kept.reserve(sorted.size() - deadCount);
+            std::copy_if(sorted.begin(), sorted.end(), std::back_inserter(kept), live);
+            std::merge(kept.begin(), kept.end(), delta.begin(), delta.end(), std::back_inserter(merged), before);
+            sorted.swap(merged);
+            delta.clear();
+            deadCount = 0;
+            rebuildFences();
+        }
+
+        void rebuildFences() {
+            fences.clear();
+            for (size_t i = 0; i < sorted.size(); i += FENCE_STRIDE) {
+                fences.push_back(sorted[i].key);
+            }
+        }
+
+        Key Bid::*field;
+        vector<Entry> sorted;
+        vector<Key> fences;
+        vector<Entry> delta;
+        size_t deadCount = 0;
+        bool isBuilt = false;
+    };
+
+    RangeIndex<double> amountIndex{&Bid::amount};
+    RangeIndex<int> closeDateIndex{&Bid::closeDate};
+
+    // build an optional range index from every stored bid
+    template <typename Key>
+    void ensureBuilt(RangeIndex<Key>& index) {
+        if (!index.built()) index.build(table);
+    }
+
+    void indexPayload(unsigned int payload);
+    void unindexPayload(unsigned int payload);
 
 public:
-    HashTable();
-    HashTable(unsigned int size);
-    virtual ~HashTable();
+    BidTable();
+    BidTable(unsigned int size);
      // tightening parameter types
     void Insert(const Bid& bid);
+    void BulkLoad(vector<Bid> bids);
     void Remove(const std::string& bidId);
     Bid  Search(const std::string& bidId);
+    void SearchBatch(std::span<const std::string_view> bidIds, std::span<const Bid*> results) const;
     void PrintAll() const;
+    unsigned int Size() const;
+    BidColumns Columns(GroupBy groupBy) const;
+
+    template <typename Key>
+    vector<Bid> TopK(size_t k, Key Bid::*field) const;
+
+    // Visit every stored bid in bucket order
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        table.forEach(visit);
+    }
 
-    // Hash a string bidId into a bucket index using std::hash<string>
-    unsigned int hash(const std::string& key) const;
+    // Visit the bids of one fund; O(bids in that fund), not O(table)
+    template <typename Visitor>
+    void ForEachInFund(const std::string& fund, Visitor visit) const {
+        for (unsigned int payload : fundIndex.find(fund)) visit(table.value(payload));
+    }
+
+    // Visit the bids of one department; O(bids in that department)
+    template <typename Visitor>
+    void ForEachInDepartment(const std::string& department, Visitor visit) const {
+        for (unsigned int payload : departmentIndex.find(department)) visit(table.value(payload));
+    }
+
+    // Visit bids with lo <= amount <= hi, lowest amount first; O(log n + k)
+    template <typename Visitor>
+    void ForEachInAmountRange(double lo, double hi, Visitor visit) {
+        ensureBuilt(amountIndex);
+        amountIndex.scan(lo, hi, [&](unsigned int payload) { visit(table.value(payload)); });
+    }
+
+    // Visit bids closed between two yyyymmdd dates (inclusive), earliest first
+    template <typename Visitor>
+    void ForEachInCloseDateRange(int from, int to, Visitor visit) {
+        ensureBuilt(closeDateIndex);
+        closeDateIndex.scan(from, to, [&](unsigned int payload) { visit(table.value(payload)); });
+    }
+
+    // Hash a string bidId into a bucket index using the hash policy
+    unsigned int hash(std::string_view key) const;
 
 };
 
 /**
  * Default constructor
  **/
-HashTable::HashTable() {
-    tableSize = DEFAULT_SIZE;
-    // Initalize node structure by resizing tableSize
-    nodes.resize(tableSize); // single head node per bucket
+BidTable::BidTable() : table(DEFAULT_SIZE) {
 }
 
 /**
  * Constructor for specifying size of the table
  * Use to improve efficiency of hashing algorithm
  * by reducing collisions without wasting memory.
+ * The size is rounded up to a power of two.
  **/
-HashTable::HashTable(unsigned int size) {
-    // invoke local tableSize to size with this ->
-    this->tableSize = (size == 0 ? DEFAULT_SIZE : size);
-
-    // resize nodes size
-    nodes.resize(this->tableSize);
+BidTable::BidTable(unsigned int size) : table(size) {
 }
 
-
 /**
- * Destructor
+ * Add a stored bid to the secondary indexes
+ * (the range indexes only once a query has built them).
  **/
+void BidTable::indexPayload(unsigned int payload) {
+    const Bid& bid = table.value(payload);
+    fundIndex.add(payload, bid.fund);
+    departmentIndex.add(payload, bid.department);
+    amountIndex.add(payload, bid);
+    closeDateIndex.add(payload, bid);
+}
 
-HashTable::~HashTable() {
-    for (unsigned int bucket_index = 0; bucket_index < tableSize; ++bucket_index) {
-        // start at head in the buckets chain
-        Node *head = &nodes[bucket_index];
-        Node *curr_bucket = head->next;
-        // walk to delete chain
-        while (curr_bucket != nullptr) {
-            Node *nextBucket = curr_bucket->next;
-            // free the current bucket
-            delete curr_bucket;
-            //move to the nextBucket
-            curr_bucket = nextBucket;
-        }
-        // reset head so buckets empty
-        nodes[bucket_index].next = nullptr;
-        nodes[bucket_index].key = UINT_MAX;
-    }
-    // erase head the vector of heads
-    nodes.clear();
+/**
+ * Take a stored bid out of the secondary indexes; call before the bid changes.
+ **/
+void BidTable::unindexPayload(unsigned int payload) {
+    const Bid& bid = table.value(payload);
+    fundIndex.drop(payload);
+    departmentIndex.drop(payload);
+    amountIndex.drop(payload, bid);
+    closeDateIndex.drop(payload, bid);
 }
 
 /**
  * Calculate the hash value of a string key (ex bidId).
- * Uses std::hash<std::string> which safely handle alphanumeric IDs.
+ * Hashes with WyHash, which safely handles alphanumeric IDs, and masks
+ * the hash down to the table size.
  * Preferred overload for all bidId lookups.
  *
  * @param key The string key to hash
  * @return The bucket index (0 .. tableSize-1)
  */
-unsigned int HashTable::hash(const std::string& key) const {
-    return std::hash<std::string>{}(key) % tableSize;
+unsigned int BidTable::hash(std::string_view key) const {
+    return table.bucket(key);
 }
 
 
 /**
  * Insert a bid into the hash table.
  *
- * The bid is hashed using its bidId (string) to compute a bucket index.
- * If the bucket head is empty, store the bid directly in the head node.
- * If the bucket already has a head:
- *   -Walk the linked list at this bucket.
- *   - If a node with the same bidId is found, replace it, update in place
- *   - Otherwise, append a new node to the end of the chain.
- *
- * This prevents collisions from overwriting data
- * by using chaining, linked lists per bucket.
+ * The table finds the bid's slot by bidId, chaining a new node when the
+ * bucket is taken and doubling itself once there are as many bids as
+ * buckets (see HashTable::tryEmplace).
+ *   - If a bid with the same bidId is stored, replace it in its slot.
+ *   - Otherwise the bid goes into a fresh slot.
+ * The fund and department indexes follow every insert and overwrite.
  *
  * @param bid The bid to insert (const reference to avoid copies).
  */
+void BidTable::Insert(const Bid& bid) {
+    auto [payload, inserted] = table.tryEmplace(bid.bidId, bid);
+    if (!inserted) {
+        // update the existing bid
+        unindexPayload(payload);
+        table.value(payload) = bid;
+    }
+    indexPayload(payload);
+}
 
-void HashTable::Insert(const Bid& bid) {
-    // compute bucket index from the string bidId (works for alphanumeric IDs)
-    unsigned int bucket_index = hash(bid.bidId);
-    Node* head = &nodes[bucket_index];
-
-    // In each bucket, nodes[bucket_index] is a head node.
-    // head.key == UINT_MAX means "this bucket is empty".
-    if (head->key == UINT_MAX) {
-        head->key = bucket_index;
-        head->bid = bid;
-        head->next = nullptr;
+/**
+ * Build the table from a whole batch of bids in one pass.
+ *
+ * The table does the heavy lifting (see HashTable::bulkLoad): it sizes
+ * itself for the batch, partitions the bids by bucket, dedups every
+ * bucket with a later bid winning, and lays the chains out contiguously,
+ * across worker threads. Bids already in the table are kept and treated
+ * as older than the batch.
+ * Every bid comes back in a new slot, so the fund and department indexes
+ * are rebuilt and the range indexes are dropped until the next range query.
+ *
+ * @param bids The bids to load, in file order.
+ */
+void BidTable::BulkLoad(vector<Bid> bids) {
+    vector<pair<string, Bid>> entries;
+    entries.reserve(bids.size());
+    for (Bid& bid : bids) {
+        string key = bid.bidId;
+        entries.emplace_back(std::move(key), std::move(bid));
+    }
+
+    fundIndex.clear();
+    departmentIndex.clear();
+    amountIndex.reset();
+    closeDateIndex.reset();
+    table.bulkLoad(std::move(entries));
+
+    // index pass: slots are numbered 0 .. Size() - 1 after a bulk load
+    for (unsigned int payload = 0; payload < table.size(); ++payload) {
+        indexPayload(payload);
+    }
+}
+
+/**
+ * Print all bids stored in the hash table, in bucket order.
+ *
+ * Output format: bidId, title, amount, fund
+ */
+void BidTable::PrintAll() const {
+    printBidTableHeader(table.size());
+    ForEach(printBidTableRow);
+    printBidTableFooter();
+}
+
+/**
+ * Order two bids for a top-k list: larger field value first, ties
+ * broken by bidId so the result does not depend on the bucket layout.
+ */
+template <typename Key>
+bool ranksBefore(const Bid& a, const Bid& b, Key Bid::*field) {
+    if (a.*field != b.*field) return b.*field < a.*field;
+    return a.bidId < b.bidId;
+}
+
+/**
+ * The k bids with the largest value of a numeric field, largest first.
+ *
+ * No sort of the whole table and no copy of it: the buckets are split
+ * across workers and every worker keeps a bounded heap of its best k
+ * bids (as payload indexes), with the weakest on top so a better bid
+ * replaces it in O(log k). The worker heaps are merged at the end and
+ * only the final k bids are copied out.
+ *
+ * @param k number of bids wanted
+ * @param field the column to rank by (ex &Bid::amount)
+ */
+template <typename Key>
+vector<Bid> BidTable::TopK(size_t k, Key Bid::*field) const {
+    if (k == 0) return {};
+    auto better = [this, field](unsigned int a, unsigned int b) {
+        return ranksBefore(table.value(a), table.value(b), field);
+    };
+    vector<unsigned int> best;
+    std::mutex bestLock;
+
+    parallelFor(table.bucketCount(), [&](size_t begin, size_t end) {
+        // heap under "better": the front is the weakest kept bid
+        vector<unsigned int> heap;
+        heap.reserve(std::min<size_t>(k, table.size()));
+        table.forEachSlotInBuckets(begin, end, [&](unsigned int payload) {
+            if (heap.size() < k) {
+                heap.push_back(payload);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else if (better(payload, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = payload;
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+        });
+        std::lock_guard<std::mutex> guard(bestLock);
+        best.insert(best.end(), heap.begin(), heap.end());
+    });
+
+    // at most k per worker left; keep the overall best k
+    size_t kept = std::min(k, best.size());
+    std::partial_sort(best.begin(), best.begin() + kept, best.end(), better);
+    vector<Bid> result;
+    result.reserve(kept);
+    for (size_t i = 0; i < kept; ++i) {
+        result.push_back(table.value(best[i]));
+    }
+    return result;
+}
+
+/**
+ * Number of bids stored in the table.
+ */
+unsigned int BidTable::Size() const {
+    return table.size();
+}
+
+/**
+ * Copy the bid amounts out into a column, group by group.
+ *
+ * The fund and department indexes already hold every group's bids, so
+ * grouping costs no hashing or sorting: the group sizes give each
+ * group's offset up front and the gather runs in parallel.
+ *
+ * @param groupBy the column to group by, or NONE for one group
+ */
+BidColumns BidTable::Columns(GroupBy groupBy) const {
+    BidColumns columns;
+    vector<std::span<const unsigned int>> groups;
+    if (groupBy == GroupBy::NONE) {
+        columns.amount.reserve(table.size());
+        ForEach([&columns](const Bid& bid) { columns.amount.push_back(bid.amount); });
+        columns.groupStart = {0, columns.amount.size()};
+        columns.groupNames.emplace_back();
+        return columns;
+    }
+
+    const GroupIndex& index = (groupBy == GroupBy::FUND) ? fundIndex : departmentIndex;
+    columns.groupStart.push_back(0);
+    index.forEachGroup([&](const string& name, std::span<const unsigned int> posting) {
+        if (posting.empty()) return;
+        columns.groupNames.push_back(name);
+        groups.push_back(posting);
+        columns.groupStart.push_back(columns.groupStart.back() + posting.size());
+    });
+
+    // gather pass (parallel): each worker fills its slice of the column
+    columns.amount.resize(columns.groupStart.back());
+    parallelFor(columns.amount.size(), [&](size_t begin, size_t end) {
+        size_t group = std::upper_bound(columns.groupStart.begin(), columns.groupStart.end(), begin)
+                       - columns.groupStart.begin() - 1;
+        for (size_t i = begin; i < end; ++i) {
+            while (i >= columns.groupStart[group + 1]) {
+                group++;
+            }
+            columns.amount[i] = table.value(groups[group][i - columns.groupStart[group]]).amount;
+        }
+    });
+    return columns;
+}
+
+/**
+ * Display the boxed "All Bids" header and the column titles.
+ *
+ * @param bidCount number of bids shown in the title
+ * @param title text shown before the count
+ */
+void printBidTableHeader(unsigned int bidCount, const string& title) {
+    // display header box
+    cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+    cout << Color::BRIGHT_BLUE << "|                              " << Color::BRIGHT_CYAN << title << " (" << bidCount << ")" << Color::BRIGHT_BLUE;
+    // pad the header to match box width (77 inner chars)
+    string countStr = to_string(bidCount);
+    for (size_t i = title.length() + 3 + countStr.length(); i < 47; ++i) cout << " ";
+    cout << "|" << Color::RESET << endl;
+    cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+
+    // column headers with wide spacing
+    cout << Color::BRIGHT_YELLOW << "  ID          Title                            Amount          Fund" << Color::RESET << endl;
+    cout << Color::BRIGHT_BLUE << "  ----------  -------------------------------  --------------  ----------------" << Color::RESET << endl;
+}
+
+/**
+ * Display one bid as a row of the "All Bids" box.
+ *
+ * @param bid the bid to print
+ */
+void printBidTableRow(const Bid& bid) {
+    // format: ID, truncated title, amount, fund
+    string title = bid.title;
+    if (title.length() > 31) title = title.substr(0, 28) + "...";
+
+    cout << "  " << Color::BRIGHT_CYAN << bid.bidId << Color::RESET;
+    // pad bidId to 12 chars
+    for (size_t i = bid.bidId.length(); i < 12; ++i) cout << " ";
+
+    cout << title;
+    // pad title to 33 chars
+    for (size_t i = title.length(); i < 33; ++i) cout << " ";
+
+    // format amount - clean display without trailing zeros
+    double amt = bid.amount;
+    string amtStr;
+    if (amt == static_cast<int>(amt)) {
+        // whole number - no decimals needed
+        amtStr = "$" + to_string(static_cast<int>(amt));
+    } else {
+        // has decimals - show up to 2 decimal places
+        amtStr = "$" + to_string(amt);
+        size_t dotPos = amtStr.find('.');
+        if (dotPos != string::npos && amtStr.length() > dotPos + 3) {
+            amtStr = amtStr.substr(0, dotPos + 3);
+        }
+        // remove trailing zero if only one decimal
+        if (amtStr.length() > 2 && amtStr.back() == '0' && amtStr[amtStr.length()-2] != '.') {
+            amtStr.pop_back();
+        }
+    }
+    cout << Color::BRIGHT_GREEN << amtStr << Color::RESET;
+    // pad amount to 16 chars
+    for (size_t i = amtStr.length(); i < 16; ++i) cout << " ";
+
+    cout << Color::MAGENTA << bid.fund << Color::RESET << endl;
+}
+
+/**
+ * Close the "All Bids" box.
+ */
+void printBidTableFooter() {
+    cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+}
+
+/**
+ * COUNT / SUM / MIN / MAX / AVG of the amount column, per group.
+ *
+ * The column is split into contiguous ranges, one per worker. Every
+ * worker runs the vectorised kernel over the part of each group that
+ * falls in its range, giving partial aggregates per group. The partials
+ * are then merged in range order, so the sums do not depend on how
+ * the threads were scheduled.
+ *
+ * @param columns the column snapshot, laid out group by group
+ * @return one aggregate per group of the snapshot
+ */
+vector<Aggregate> aggregateColumns(const BidColumns& columns) {
+    size_t groupCount = columns.groupNames.size();
+    vector<pair<size_t, vector<Aggregate>>> partials;
+    std::mutex partialsLock;
+    parallelFor(columns.amount.size(), [&](size_t begin, size_t end) {
+        vector<Aggregate> partial(groupCount);
+        size_t group = std::upper_bound(columns.groupStart.begin(), columns.groupStart.end(), begin)
+                       - columns.groupStart.begin() - 1;
+        for (size_t first = begin; first < end; ++group) {
+            size_t last = std::min(end, columns.groupStart[group + 1]);
+            partial[group] = aggregateRange(columns.amount.data() + first, last - first);
+            first = last;
+        }
+        std::lock_guard<std::mutex> guard(partialsLock);
+        partials.emplace_back(begin, std::move(partial));
+    });
+
+    sort(partials.begin(), partials.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    vector<Aggregate> result(groupCount);
+    for (const auto& partial : partials) {
+        for (size_t group = 0; group < groupCount; ++group) {
+            result[group].merge(partial.second[group]);
+        }
+    }
+    return result;
+}
+
+/**
+ * Display per-group aggregates of the winning bids in a themed box.
+ *
+ * @param title shown in the header of the box
+ * @param columns the snapshot the aggregates were computed over
+ * @param aggregates one aggregate per group of columns
+ */
+void printAggregateTable(const string& title, const BidColumns& columns, const vector<Aggregate>& aggregates) {
+    cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+    cout << Color::BRIGHT_BLUE << "|  " << Color::BRIGHT_CYAN << title << Color::BRIGHT_BLUE;
+    for (size_t i = title.length(); i < 75; ++i) cout << " ";
+    cout << "|" << Color::RESET << endl;
+    cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+
+    cout << Color::BRIGHT_YELLOW << "  Group                     Count           Sum        Min        Max        Avg" << Color::RESET << endl;
+    for (size_t group = 0; group < aggregates.size(); ++group) {
+        const Aggregate& stats = aggregates[group];
+        string name = columns.groupNames[group].empty() ? "(none)" : columns.groupNames[group];
+        if (name.length() > 24) name = name.substr(0, 21) + "...";
+        char line[128];
+        snprintf(line, sizeof(line), "%8zu %13.2f %10.2f %10.2f %10.2f",
+                 stats.count, stats.sum, stats.count ? stats.min : 0.0, stats.count ? stats.max : 0.0, stats.average());
+        cout << "  " << Color::MAGENTA << name << Color::RESET;
+        for (size_t i = name.length(); i < 24; ++i) cout << " ";
+        cout << line << endl;
+    }
+    printBidTableFooter();
+}
+
+/**
+* Remove a bid by bidId.
+*
+* The table unlinks the bid's node (see HashTable::erase); the bid
+* leaves the fund and department indexes just before its slot is freed.
+*/
+void BidTable::Remove(const std::string& bidId) {
+    table.erase(bidId, [this](unsigned int payload) { unindexPayload(payload); });
+}
+
+
+/**
+* Search for a bid by bidId.
+*
+* Process:
+*  - Hash the bidId (string-based hash) to find its bucket.
+*  - Walk that bucket's chain; nodes whose stored hash differs are
+*    skipped without reading their bid.
+*  - If no match is found, return default-constructed Bid
+*    (with bidId == "") signifying "not found".
+*
+* @param bidId The bid identifier string to look up.
+* @return The matching Bid if found, or an empty Bid otherwise.
+*/
+Bid BidTable::Search(const std::string& bidId) {
+    const Bid *found = table.find(bidId);
+    return found != nullptr ? *found : Bid(); // empty Bid; "not found" result
+}
+
+/**
+* Search for a batch of bids at once, with the chain walks of up to
+* 16 lookups interleaved so their cache misses overlap
+* (see HashTable::findBatch).
+*
+* @param bidIds The bid identifiers to look up.
+* @param results Receives a pointer to each matching bid, or nullptr when
+*                the id is not stored. Pointers stay valid until the
+*                table is next modified.
+*/
+void BidTable::SearchBatch(std::span<const std::string_view> bidIds, std::span<const Bid*> results) const {
+    table.findBatch(bidIds, results);
+}
+
+
+//============================================================================
+// Sharded Hash Table class definition
+//============================================================================
+
+/**
+ * Split the key space across independent BidTable shards.
+ *
+ * The shard is chosen from the high bits of the bidId hash times a
+ * Fibonacci constant (which depend on every bit of the hash, even for
+ * IdentityHash), the low bits still choose the bucket inside that
+ * shard. Every shard is owned by one worker thread (pinned to its own
+ * core on Linux) and only that thread ever touches the shard's table,
+ * so the tables need no locks at all.
+ * Callers post commands to the owner's SPSC mailbox; anything that spans
+ * shards (Size, PrintAll) is scattered to every owner and the partial
+ * results are gathered back.
+ *
+ * Mailboxes are single-producer: drive a ShardedHashTable from one
+ * thread at a time.
+ **/
+class ShardedHashTable {
+private:
+    // A request for a shard owner
+    struct Command {
+        enum Kind { INSERT, REMOVE, TASK, STOP };
+
+        Kind kind = TASK;
+        Bid bid;                              // INSERT payload, REMOVE key
+        std::function<void(BidTable&)> task; // TASK body, runs on the owner
+    };
+
+    // One table plus its owner, padded to its own cache lines
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        BidTable table;
+        SpscRing<Command> mailbox;
+        std::thread owner;
+
+        Shard(unsigned int size) : table(size), mailbox(MAILBOX_SIZE) {}
+    };
+
+    vector<unique_ptr<Shard>> shards;
+
+    // log2 of the shard count
+    unsigned int shardBits = 0;
+
+    static void runShard(Shard *shard);
+
+    template <typename Result, typename Task>
+    vector<Result> scatterGather(Task task);
+
+public:
+    ShardedHashTable();
+    ShardedHashTable(unsigned int shardCount, unsigned int shardSize = DEFAULT_SIZE);
+    ~ShardedHashTable();
+
+    void Insert(const Bid& bid);
+    void Remove(const std::string& bidId);
+    Bid  Search(const std::string& bidId);
+    void PrintAll();
+    unsigned int Size();
+    unsigned int ShardCount() const;
+
+    template <typename Key>
+    vector<Bid> TopK(size_t k, Key Bid::*field);
+
+    // Pick the shard owning a bidId from the high bits of its hash
+    unsigned int shardOf(const std::string& key) const;
+};
+
+/**
+ * Default constructor, one shard per hardware thread
+ **/
+ShardedHashTable::ShardedHashTable() : ShardedHashTable(std::thread::hardware_concurrency()) {
+}
+
+/**
+ * Start shardCount shards, each with shardSize buckets.
+ *
+ * The shard count is rounded down to a power of two so the shard index
+ * is a plain shift of the hash.
+ **/
+ShardedHashTable::ShardedHashTable(unsigned int shardCount, unsigned int shardSize) {
+    while ((2u << shardBits) <= shardCount) {
+        shardBits++;
+    }
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned int shard_index = 0; shard_index < (1u << shardBits); ++shard_index) {
+        shards.push_back(make_unique<Shard>(shardSize));
+        Shard *shard = shards.back().get();
+        shard->owner = std::thread(runShard, shard);
+#ifdef __linux__
+        // best effort; an unpinned owner is still the only one touching the shard
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(shard_index % cores, &cpus);
+        pthread_setaffinity_np(shard->owner.native_handle(), sizeof(cpus), &cpus);
+#else
+        (void)cores;
+#endif
+    }
+}
+
+/**
+ * Destructor, stops and joins every owner thread
+ **/
+ShardedHashTable::~ShardedHashTable() {
+    for (auto& shard : shards) {
+        Command stop;
+        stop.kind = Command::STOP;
+        shard->mailbox.push(std::move(stop));
+    }
+    for (auto& shard : shards) {
+        shard->owner.join();
+    }
+}
+
+/**
+ * Owner loop: apply commands to the shard's table in arrival order
+ **/
+void ShardedHashTable::runShard(Shard *shard) {
+    Command cmd;
+    while (true) {
+        shard->mailbox.pop(cmd);
+        switch (cmd.kind) {
+            case Command::INSERT:
+                shard->table.Insert(cmd.bid);
+                break;
+            case Command::REMOVE:
+                shard->table.Remove(cmd.bid.bidId);
+                break;
+            case Command::TASK:
+                cmd.task(shard->table);
+                cmd.task = nullptr;
+                break;
+            case Command::STOP:
+                return;
+        }
+    }
+}
+
+/**
+ * Run task on every shard owner and collect one result per shard.
+ *
+ * Mailboxes are FIFO, so each partial result reflects every command
+ * posted to that shard before the scatter.
+ **/
+template <typename Result, typename Task>
+vector<Result> ShardedHashTable::scatterGather(Task task) {
+    vector<promise<Result>> partials(shards.size());
+    vector<future<Result>> pending;
+    for (auto& partial : partials) {
+        pending.push_back(partial.get_future());
+    }
+
+    // scatter
+    for (size_t shard_index = 0; shard_index < shards.size(); ++shard_index) {
+        Command cmd;
+        promise<Result> *partial = &partials[shard_index];
+        cmd.task = [partial, task](BidTable& table) { partial->set_value(task(table)); };
+        shards[shard_index]->mailbox.push(std::move(cmd));
+    }
+
+    // gather
+    vector<Result> results;
+    for (auto& result : pending) {
+        results.push_back(result.get());
+    }
+    return results;
+}
+
+unsigned int ShardedHashTable::shardOf(const std::string& key) const {
+    if (shardBits == 0) {
+        return 0;
+    }
+    uint64_t hashed = static_cast<uint64_t>(WyHash{}(key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<unsigned int>(hashed >> (64 - shardBits));
+}
+
+/**
+ * Queue a bid for insertion on its owning shard.
+ * Returns as soon as the command is posted.
+ **/
+void ShardedHashTable::Insert(const Bid& bid) {
+    Command cmd;
+    cmd.kind = Command::INSERT;
+    cmd.bid = bid;
+    shards[shardOf(bid.bidId)]->mailbox.push(std::move(cmd));
+}
+
+/**
+ * Queue removal of a bidId on its owning shard.
+ **/
+void ShardedHashTable::Remove(const std::string& bidId) {
+    Command cmd;
+    cmd.kind = Command::REMOVE;
+    cmd.bid.bidId = bidId;
+    shards[shardOf(bidId)]->mailbox.push(std::move(cmd));
+}
+
+/**
+ * Search for a bid by bidId on its owning shard and wait for the answer.
+ *
+ * @return The matching Bid if found, or an empty Bid otherwise.
+ **/
+Bid ShardedHashTable::Search(const std::string& bidId) {
+    promise<Bid> found;
+    future<Bid> result = found.get_future();
+
+    Command cmd;
+    cmd.task = [&found, &bidId](BidTable& table) { found.set_value(table.Search(bidId)); };
+    shards[shardOf(bidId)]->mailbox.push(std::move(cmd));
+    return result.get();
+}
+
+/**
+ * Total number of bids, summed over every shard.
+ **/
+unsigned int ShardedHashTable::Size() {
+    unsigned int total = 0;
+    for (unsigned int count : scatterGather<unsigned int>([](BidTable& table) { return table.Size(); })) {
+        total += count;
+    }
+    return total;
+}
+
+unsigned int ShardedHashTable::ShardCount() const {
+    return static_cast<unsigned int>(shards.size());
+}
+
+/**
+ * The k bids with the largest value of a numeric field, largest first.
+ * Every shard owner computes its own top k; only those k bids per shard
+ * are copied back and merged.
+ */
+template <typename Key>
+vector<Bid> ShardedHashTable::TopK(size_t k, Key Bid::*field) {
+    vector<vector<Bid>> tops = scatterGather<vector<Bid>>([k, field](BidTable& table) {
+        return table.TopK(k, field);
+    });
+
+    vector<Bid> result;
+    for (auto& top : tops) {
+        std::move(top.begin(), top.end(), std::back_inserter(result));
+    }
+    size_t kept = std::min(k, result.size());
+    std::partial_sort(result.begin(), result.begin() + kept, result.end(),
+                      [field](const Bid& a, const Bid& b) { return ranksBefore(a, b, field); });
+    result.resize(kept);
+    return result;
+}
+
+/**
+ * Print all bids, shard after shard.
+ *
+ * Each owner snapshots its own bids; the calling thread prints them
+ * so the output is never interleaved.
+ **/
+void ShardedHashTable::PrintAll() {
+    vector<vector<Bid>> snapshots = scatterGather<vector<Bid>>([](BidTable& table) {
+        vector<Bid> bids;
+        bids.reserve(table.Size());
+        table.ForEach([&bids](const Bid& bid) { bids.push_back(bid); });
+        return bids;
+    });
+
+    unsigned int total = 0;
+    for (const auto& snapshot : snapshots) {
+        total += snapshot.size();
+    }
+
+    printBidTableHeader(total);
+    for (const auto& snapshot : snapshots) {
+        for (const Bid& bid : snapshot) {
+            printBidTableRow(bid);
+        }
+    }
+    printBidTableFooter();
+}
+
+
+    //============================================================================
+    // Static methods used for testing
+    //============================================================================
+
+    /**
+     * Display the bid information to the console (std::out)
+     *
+     * @param bid struct containing the bid info
+     **/
+    void displayBid(Bid bid) {
+        cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
+                << bid.fund << endl;
         return;
     }
-    // walk the chain; checks for duplicate or append
-    Node *curr_bucket = head;
-    while (curr_bucket->next != nullptr) {
-        // check last node for same-id overwrite
-        if (curr_bucket->bid.bidId == bid.bidId) {
-            //update the existing bid
-            curr_bucket->bid = bid;
+
+    /**
+     * Display the file, column count and row count of a load in a themed box
+     **/
+    void printLoadInfo(const string& csvPath, size_t colCount, size_t rowCount) {
+        const size_t boxWidth = 42; // content width after "| "
+
+        cout << Color::BRIGHT_BLUE << "+-------------------------------------------+" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "|            " << Color::BRIGHT_CYAN << "Loading CSV Data" << Color::BRIGHT_BLUE << "               |" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "+-------------------------------------------+" << Color::RESET << endl;
+
+        // File row
+        string fileContent = "File: " + csvPath;
+        cout << Color::BRIGHT_BLUE << "| " << Color::BRIGHT_YELLOW << "File: " << Color::RESET << csvPath;
+        for (size_t i = fileContent.length(); i < boxWidth; ++i) cout << " ";
+        cout << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+
+        // Columns row
+        string colContent = "Columns: " + to_string(colCount);
+        cout << Color::BRIGHT_BLUE << "| " << Color::BRIGHT_YELLOW << "Columns: " << Color::RESET << colCount;
+        for (size_t i = colContent.length(); i < boxWidth; ++i) cout << " ";
+        cout << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+
+        // Rows row
+        string rowContent = "Rows: " + to_string(rowCount);
+        cout << Color::BRIGHT_BLUE << "| " << Color::BRIGHT_YELLOW << "Rows: " << Color::RESET << rowCount;
+        for (size_t i = rowContent.length(); i < boxWidth; ++i) cout << " ";
+        cout << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+
+        cout << Color::BRIGHT_BLUE << "+-------------------------------------------+" << Color::RESET << endl;
+    }
+
+    // the Close Date and Winning Bid columns, read the way the menu reads them
+    void convertCloseDate(std::string_view field, int& closeDate) {
+        closeDate = parseDate(string(field));
+    }
+
+    // large amounts are quoted with thousands separators, ex "$10,500.00"
+    void convertAmount(std::string_view field, double& amount) {
+        string text(field);
+        text.erase(remove(text.begin(), text.end(), ','), text.end());
+        amount = strToDouble(text, '$');
+    }
+
+    /**
+     * Where every Bid member comes from in an eBid export, by header name.
+     * Names are matched with surrounding blanks trimmed; the second name
+     * of a column is the one the Dec 2016 style exports use. The column
+     * positions are resolved once per file, from its header.
+     **/
+    constexpr auto BID_SCHEMA = csv::Schema(
+        csv::bind(&Bid::title, "Auction Title", "ArticleTitle"),
+        csv::bind(&Bid::bidId, "Auction ID", "ArticleID"),
+        csv::bind(&Bid::department, "Department"),
+        csv::bind(&Bid::closeDate, convertCloseDate, "Close Date", "CloseDate"),
+        csv::bind(&Bid::amount, convertAmount, "Winning Bid", "WinningBid"),
+        csv::bind(&Bid::fund, "Fund"));
+
+    /**
+     * Convert every row of a parsed export into a Bid through BID_SCHEMA
+     *
+     * Workers convert contiguous row ranges straight into their own slots
+     * of the result, which keeps file order (and so last-write-wins for
+     * duplicate IDs). Reading rows of a parsed file from several threads
+     * at once is safe.
+     *
+     * @param file the parsed CSV file
+     * @return the converted bids, in file order
+     * @throws csv::Error when a bound column is missing from the header
+     **/
+    vector<Bid> convertBids(const csv::Parser& file) {
+        // the Bid columns are looked up by name once, not per row
+        auto layout = BID_SCHEMA.resolve(file.getHeader());
+        vector<Bid> bids(file.rowCount());
+        parallelFor(bids.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                BID_SCHEMA.assign(file[i], layout, bids[i]);
+            }
+        });
+        return bids;
+    }
+
+    /**
+     * Load a CSV file containing bids into a container
+     *
+     * @param csvPath the path to the CSV file to load
+     * @return a container holding all the bids read
+     **/
+    void loadBids(string csvPath, BidTable *hashTable) {
+        size_t columnCount = 0;
+        vector<Bid> bids;
+        try {
+            csv::Parser file(csvPath);
+            columnCount = file.columnCount();
+            bids = convertBids(file);
+        } catch (csv::Error &e) {
+            std::cerr << e.what() << std::endl;
+            return;
+        }
+
+        // display loading info in a themed box
+        printLoadInfo(csvPath, columnCount, bids.size());
+
+        // the bids are all known up front, so build the table in one pass
+        hashTable->BulkLoad(std::move(bids));
+    }
+
+    /**
+     * Order key of a monthly export, taken from a "_<Mon>_<YYYY>" part of
+     * its file name (ex eBid_Monthly_Sales_Dec_2016.csv, or .csv.gz).
+     *
+     * @return year * 12 + month, or -1 when the name carries no month
+     **/
+    int exportMonth(const std::filesystem::path& path) {
+        static const string months[] = {"january", "february", "march", "april", "may", "june", "july",
+                                         "august", "september", "october", "november", "december"};
+        vector<string> parts;
+        // everything before the first dot, so compressed exports sort too
+        string name = path.filename().string();
+        std::stringstream stem(name.substr(0, name.find('.')));
+        for (string part; getline(stem, part, '_');) {
+            transform(part.begin(), part.end(), part.begin(), [](unsigned char c) { return std::tolower(c); });
+            parts.push_back(part);
+        }
+        for (size_t i = 0; i + 1 < parts.size(); ++i) {
+            const string& year = parts[i + 1];
+            if (year.length() != 4 || !all_of(year.begin(), year.end(), [](unsigned char c) { return std::isdigit(c); })) {
+                continue;
+            }
+            for (int month = 0; month < 12; ++month) {
+                // accept "dec" and "december"
+                if (parts[i] == months[month] || parts[i] == months[month].substr(0, 3)) {
+                    return stoi(year) * 12 + month;
+                }
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Match a file name against a shell-style pattern with * and ?
+     **/
+    bool wildcardMatch(const char *pattern, const char *name) {
+        if (*pattern == '\0') {
+            return *name == '\0';
+        }
+        if (*pattern == '*') {
+            return wildcardMatch(pattern + 1, name) || (*name != '\0' && wildcardMatch(pattern, name + 1));
+        }
+        return *name != '\0' && (*pattern == '?' || *pattern == *name) && wildcardMatch(pattern + 1, name + 1);
+    }
+
+    /**
+     * Whether a file name is a CSV export, plain or compressed
+     **/
+    bool isCsvFile(const std::filesystem::path& path) {
+        static const string extensions[] = {".csv", ".csv.gz", ".csv.zst"};
+        string name = path.filename().string();
+        for (const string& extension : extensions) {
+            if (name.length() > extension.length() &&
+                name.compare(name.length() - extension.length(), string::npos, extension) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Expand a CSV argument into the files it names
+     *
+     *  - a directory: every .csv (or .csv.gz, .csv.zst) file in it
+     *  - a pattern with * or ? in the file name part: the matching files
+     *  - anything else: that single path
+     *
+     * Files are returned oldest export first (see exportMonth); files
+     * without a month in their name count as the oldest.
+     **/
+    vector<string> expandCsvPaths(const string& csvPath) {
+        namespace fs = std::filesystem;
+        fs::path path(csvPath);
+        vector<fs::path> files;
+
+        std::error_code ec;
+        if (fs::is_directory(path, ec)) {
+            for (const auto& entry : fs::directory_iterator(path, ec)) {
+                if (entry.is_regular_file(ec) && isCsvFile(entry.path())) {
+                    files.push_back(entry.path());
+                }
+            }
+        } else if (path.filename().string().find_first_of("*?") != string::npos) {
+            fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+            string pattern = path.filename().string();
+            for (const auto& entry : fs::directory_iterator(dir, ec)) {
+                if (entry.is_regular_file(ec) && wildcardMatch(pattern.c_str(), entry.path().filename().string().c_str())) {
+                    files.push_back(entry.path());
+                }
+            }
+        } else {
+            return {csvPath};
+        }
+
+        stable_sort(files.begin(), files.end(), [](const fs::path& a, const fs::path& b) {
+            int monthA = exportMonth(a), monthB = exportMonth(b);
+            return monthA != monthB ? monthA < monthB : a < b;
+        });
+        vector<string> paths;
+        for (const auto& file : files) {
+            paths.push_back(file.string());
+        }
+        return paths;
+    }
+
+    /**
+     * Load every monthly export named by a directory or a glob
+     *
+     * Each file is parsed and converted on its own thread. A file is
+     * accepted when BID_SCHEMA finds all of its columns, under any of
+     * their names, so exports with renamed or reordered columns merge
+     * too; files that miss a column (or fail to parse) are reported and
+     * skipped. The surviving files are merged oldest first into a single
+     * BulkLoad, so a later month wins when two files carry the same
+     * Auction ID. A plain file path is loaded exactly like loadBids.
+     *
+     * @param csvPath a CSV file, a directory of CSV files, or a pattern such as data/eBid_*.csv
+     * @param hashTable the table receiving the bids
+     **/
+    void loadBidFiles(string csvPath, BidTable *hashTable) {
+        vector<string> paths = expandCsvPaths(csvPath);
+        if (paths.size() == 1 && paths[0] == csvPath) {
+            loadBids(csvPath, hashTable);
+            return;
+        }
+        if (paths.empty()) {
+            cout << Color::BRIGHT_RED << "No CSV files match " << csvPath << Color::RESET << endl;
+            return;
+        }
+
+        // one slot per file, filled by whichever worker picks the file up
+        struct MonthlyExport {
+            size_t columnCount = 0;
+            vector<Bid> bids;
+            string error;
+        };
+        vector<MonthlyExport> exports(paths.size());
+        std::atomic<size_t> nextFile{0};
+        auto worker = [&]() {
+            for (size_t i = nextFile++; i < paths.size(); i = nextFile++) {
+                try {
+                    csv::Parser file(paths[i]);
+                    exports[i].bids = convertBids(file);
+                    exports[i].columnCount = file.columnCount();
+                } catch (csv::Error &e) {
+                    exports[i].error = e.what(); // reported and skipped below
+                }
+            }
+        };
+        vector<std::thread> workers;
+        size_t workerCount = std::min<size_t>(paths.size(), std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t i = 1; i < workerCount; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        // merge the readable files oldest first
+        vector<Bid> bids;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            MonthlyExport& monthly = exports[i];
+            if (!monthly.error.empty()) {
+                cout << Color::BRIGHT_RED << "Skipping " << paths[i] << ": " << monthly.error << Color::RESET << endl;
+                continue;
+            }
+            printLoadInfo(paths[i], monthly.columnCount, monthly.bids.size());
+            std::move(monthly.bids.begin(), monthly.bids.end(), std::back_inserter(bids));
+        }
+        hashTable->BulkLoad(std::move(bids));
+    }
+
+    /**
+     * Load CSV files into the table through a three stage pipeline
+     *
+     * A reader thread doing large block reads and a tokenizer thread
+     * (csv::StreamParser) feed parsed rows to this thread, which acts as
+     * the inserter: it converts and inserts each batch while the next
+     * blocks are still being read and split. The whole load takes about
+     * as long as the slowest stage rather than the sum of all three.
+     *
+     * csvPath is expanded like for loadBidFiles; the files are streamed
+     * one after the other, oldest first, so a later month wins when two
+     * files carry the same Auction ID. A file that cannot be read is
+     * reported and skipped.
+     *
+     * @param csvPath the CSV file, directory or glob to load
+     * @param hashTable the table receiving the bids
+     **/
+    void loadBidsPipelined(string csvPath, BidTable *hashTable) {
+        vector<string> paths = expandCsvPaths(csvPath);
+        if (paths.empty()) {
+            cout << Color::BRIGHT_RED << "No CSV files match " << csvPath << Color::RESET << endl;
+            return;
+        }
+
+        for (const string& path : paths) {
+            size_t columnCount = 0;
+            size_t rowCount = 0;
+            try {
+                csv::StreamParser stream(path);
+                columnCount = stream.getHeader().size();
+
+                // the Bid columns are looked up by name once, not per row
+                auto layout = BID_SCHEMA.resolve(stream.getHeader());
+
+                csv::RowBatch rows;
+                while (stream.nextBatch(rows)) {
+                    for (const auto& fields : rows) {
+                        Bid bid;
+                        BID_SCHEMA.assign(fields, layout, bid);
+                        hashTable->Insert(bid);
+                    }
+                    rowCount += rows.size();
+                }
+            } catch (csv::Error &e) {
+                if (paths.size() == 1) {
+                    std::cerr << e.what() << std::endl;
+                } else {
+                    cout << Color::BRIGHT_RED << "Skipping " << path << ": " << e.what() << Color::RESET << endl;
+                }
+                continue;
+            }
+
+            // the row count is only known once the stream is done
+            printLoadInfo(path, columnCount, rowCount);
+        }
+    }
+
+    /**
+     * Time one hash policy over a set of bids: hash every bidId, bulk load
+     * a table keyed by that policy, then look every bid up again in
+     * batches. The longest chain shows how evenly the policy spread the
+     * ids over the buckets.
+     *
+     * @param bids the bids to load, with distinct bidIds
+     * @param rounds passes over the ids for the hash and lookup timings
+     **/
+    template <typename Policy>
+    void benchmarkHashPolicy(const vector<Bid>& bids, size_t rounds) {
+        vector<std::string_view> ids;
+        ids.reserve(bids.size());
+        for (const Bid& bid : bids) {
+            ids.push_back(bid.bidId);
+        }
+        size_t probes = rounds * ids.size();
+
+        auto started = std::chrono::steady_clock::now();
+        size_t sink = 0;
+        for (size_t round = 0; round < rounds; ++round) {
+            for (std::string_view id : ids) {
+                sink += Policy{}(id);
+            }
+        }
+        std::chrono::duration<double, std::nano> hashing = std::chrono::steady_clock::now() - started;
+        volatile size_t keep = sink; // the hashes must not be optimized away
+        (void)keep;
+
+        vector<pair<string, Bid>> entries;
+        entries.reserve(bids.size());
+        for (const Bid& bid : bids) {
+            entries.emplace_back(bid.bidId, bid);
+        }
+        HashTable<string, Bid, Policy, std::equal_to<>> table;
+        started = std::chrono::steady_clock::now();
+        table.bulkLoad(std::move(entries));
+        std::chrono::duration<double, std::milli> loading = std::chrono::steady_clock::now() - started;
+
+        vector<const Bid*> found(ids.size());
+        started = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < rounds; ++round) {
+            table.findBatch(std::span<const std::string_view>(ids), std::span<const Bid*>(found));
+        }
+        std::chrono::duration<double, std::nano> lookups = std::chrono::steady_clock::now() - started;
+
+        std::unordered_map<unsigned int, unsigned int> chains;
+        unsigned int longest = 0;
+        table.forEach([&](const Bid& bid) { longest = std::max(longest, ++chains[table.bucket(bid.bidId)]); });
+
+        char line[128];
+        snprintf(line, sizeof(line), "%12.1f %12.2f %12.1f %12u",
+                 hashing.count() / probes, loading.count(), lookups.count() / probes, longest);
+        string name = Policy::name;
+        cout << "  " << Color::MAGENTA << name << Color::RESET;
+        for (size_t i = name.length(); i < 12; ++i) cout << " ";
+        cout << line << endl;
+    }
+
+    /**
+     * Compare the shipped hash policies (HashPolicy.hpp) on the bids
+     * currently loaded; every policy gets its own table over a copy of them.
+     *
+     * @param hashTable the table holding the loaded bids
+     **/
+    void benchmarkHashPolicies(const BidTable *hashTable) {
+        vector<Bid> bids;
+        bids.reserve(hashTable->Size());
+        hashTable->ForEach([&bids](const Bid& bid) { bids.push_back(bid); });
+        if (bids.empty()) {
+            cout << Color::BRIGHT_RED << "Load bids before running the benchmark." << Color::RESET << endl;
             return;
         }
-        curr_bucket = curr_bucket->next;
+        // about a million hashes and lookups per policy
+        size_t rounds = std::max<size_t>(1, 1000000 / bids.size());
+
+        string title = "Hash Functions over " + std::to_string(bids.size()) + " Bids";
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "|  " << Color::BRIGHT_CYAN << title << Color::BRIGHT_BLUE;
+        for (size_t i = title.length(); i < 75; ++i) cout << " ";
+        cout << "|" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+
+        cout << Color::BRIGHT_YELLOW << "  Policy        hash ns/id      load ms lookup ns/id  longest chain" << Color::RESET << endl;
+        benchmarkHashPolicy<StdHash>(bids, rounds);
+        benchmarkHashPolicy<WyHash>(bids, rounds);
+        benchmarkHashPolicy<Xxh3Hash>(bids, rounds);
+        benchmarkHashPolicy<Crc32cHash>(bids, rounds);
+        benchmarkHashPolicy<IdentityHash>(bids, rounds);
+        printBidTableFooter();
     }
-    // final duplicate check for last node
-    if (curr_bucket->bid.bidId == bid.bidId) {
-        curr_bucket->bid = bid;
-        return;
+
+    /**
+     * Print one step of a check: its name, its wall time and whether it
+     * matched, in red when it did not
+     **/
+    void printCheck(const string& step, std::chrono::steady_clock::time_point started, bool matched) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+        char line[64];
+        snprintf(line, sizeof(line), "%10.2f ms", elapsed.count());
+        cout << "  " << Color::MAGENTA << step << Color::RESET;
+        for (size_t i = step.length(); i < 30; ++i) cout << " ";
+        cout << line << "  " << (matched ? Color::BRIGHT_GREEN : Color::BRIGHT_RED)
+             << (matched ? "ok" : "MISMATCH") << Color::RESET << endl;
     }
-    // if not found, need to append to the end of the chain
-    Node *newNode = new Node(bid, bucket_index);
-    newNode->next = nullptr;
-    curr_bucket->next = newNode;
-}
 
-/**
- * Print all bids stored in the hash table.
- *
- * Iterates over every bucket thtas in the table:
- *  - Starts at the head node for each bucket.
- *  - Walks through the linked list chain at that bucket.
- *  - Prints any node holds a bid
- *    (nodes with key == UINT_MAX are empty).
- *
- * Output format: bucket_index, bidId, title, amount, fund
- */
-void HashTable::PrintAll() const {
-    // count total bids first
-    unsigned int bidCount = 0;
-    for (unsigned int i = 0; i < tableSize; ++i) {
-        const Node *iter = &nodes[i];
-        while (iter != nullptr) {
-            if (iter->key != UINT_MAX) bidCount++;
-            iter = iter->next;
+    /**
+     * Copy the loaded bids into a ShardedHashTable and check that it
+     * answers like the table they came from: Size, a Search for every
+     * bid, the top 50 winning bids, and a Remove. Each step is timed;
+     * a step that disagrees is reported in red.
+     *
+     * @param hashTable the table holding the loaded bids
+     **/
+    void checkShardedTable(const BidTable *hashTable) {
+        vector<Bid> bids;
+        bids.reserve(hashTable->Size());
+        hashTable->ForEach([&bids](const Bid& bid) { bids.push_back(bid); });
+        if (bids.empty()) {
+            cout << Color::BRIGHT_RED << "Load bids before checking the sharded table." << Color::RESET << endl;
+            return;
+        }
+
+        ShardedHashTable sharded;
+        string title = "Sharded Table (" + std::to_string(sharded.ShardCount()) + " shards) over "
+                       + std::to_string(bids.size()) + " Bids";
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "|  " << Color::BRIGHT_CYAN << title << Color::BRIGHT_BLUE;
+        for (size_t i = title.length(); i < 75; ++i) cout << " ";
+        cout << "|" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+
+        // Size waits for every owner, so the inserts are timed to completion
+        auto started = std::chrono::steady_clock::now();
+        for (const Bid& bid : bids) {
+            sharded.Insert(bid);
+        }
+        printCheck("Insert + Size", started, sharded.Size() == bids.size());
+
+        started = std::chrono::steady_clock::now();
+        bool found = true;
+        for (const Bid& bid : bids) {
+            Bid match = sharded.Search(bid.bidId);
+            found = found && match.bidId == bid.bidId && match.amount == bid.amount && match.fund == bid.fund;
         }
+        printCheck("Search every bid", started, found);
+
+        started = std::chrono::steady_clock::now();
+        vector<Bid> top = sharded.TopK(50, &Bid::amount);
+        vector<Bid> expected = hashTable->TopK(50, &Bid::amount);
+        printCheck("Top 50 winning bids", started, std::equal(top.begin(), top.end(), expected.begin(), expected.end(),
+            [](const Bid& a, const Bid& b) { return a.bidId == b.bidId; }));
+
+        started = std::chrono::steady_clock::now();
+        sharded.Remove(bids.front().bidId);
+        bool removed = sharded.Search(bids.front().bidId).bidId.empty() && sharded.Size() == bids.size() - 1;
+        printCheck("Remove one bid", started, removed);
+        printBidTableFooter();
     }
 
-    // display header box
-    cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
-    cout << Color::BRIGHT_BLUE << "|                              " << Color::BRIGHT_CYAN << "All Bids (" << bidCount << ")" << Color::BRIGHT_BLUE;
-    // pad the header to match box width (77 inner chars)
-    string countStr = to_string(bidCount);
-    for (size_t i = 0; i < 36 - countStr.length(); ++i) cout << " ";
-    cout << "|" << Color::RESET << endl;
-    cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+    /**
+     * count bids copied round-robin from templates, with distinct numeric
+     * bidIds scattered over [firstId, firstId + 800000000)
+     **/
+    vector<Bid> syntheticBids(const vector<Bid>& templates, size_t count, uint64_t firstId) {
+        vector<Bid> bids;
+        bids.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            Bid bid = templates[i % templates.size()];
+            bid.bidId = std::to_string(firstId + i * 48271 % 800000000);
+            bids.push_back(std::move(bid));
+        }
+        return bids;
+    }
 
-    // column headers with wide spacing
-    cout << Color::BRIGHT_YELLOW << "  ID          Title                            Amount          Fund" << Color::RESET << endl;
-    cout << Color::BRIGHT_BLUE << "  ----------  -------------------------------  --------------  ----------------" << Color::RESET << endl;
+    /**
+     * Print one timed benchmark step: total wall time and time per operation
+     **/
+    void printTiming(const string& step, std::chrono::steady_clock::time_point started, size_t operations) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+        char line[64];
+        snprintf(line, sizeof(line), "%12.1f %12.1f", elapsed.count(), elapsed.count() * 1e6 / operations);
+        cout << "  " << Color::MAGENTA << step << Color::RESET;
+        for (size_t i = step.length(); i < 26; ++i) cout << " ";
+        cout << line << endl;
+    }
 
-    // iterate through every bucket in the table
-    for (unsigned int bucket_index = 0; bucket_index < tableSize; ++bucket_index) {
-        const Node *iter = &nodes[bucket_index];
-        // walk the chain for this bucket
-        while (iter != nullptr) {
-            if (iter->key != UINT_MAX) {
-                // format: ID, truncated title, amount, fund
-                string title = iter->bid.title;
-                if (title.length() > 31) title = title.substr(0, 28) + "...";
-
-                cout << "  " << Color::BRIGHT_CYAN << iter->bid.bidId << Color::RESET;
-                // pad bidId to 12 chars
-                for (size_t i = iter->bid.bidId.length(); i < 12; ++i) cout << " ";
-
-                cout << title;
-                // pad title to 33 chars
-                for (size_t i = title.length(); i < 33; ++i) cout << " ";
-
-                // format amount - clean display without trailing zeros
-                double amt = iter->bid.amount;
-                string amtStr;
-                if (amt == static_cast<int>(amt)) {
-                    // whole number - no decimals needed
-                    amtStr = "$" + to_string(static_cast<int>(amt));
-                } else {
-                    // has decimals - show up to 2 decimal places
-                    amtStr = "$" + to_string(amt);
-                    size_t dotPos = amtStr.find('.');
-                    if (dotPos != string::npos && amtStr.length() > dotPos + 3) {
-                        amtStr = amtStr.substr(0, dotPos + 3);
-                    }
-                    // remove trailing zero if only one decimal
-                    if (amtStr.length() > 2 && amtStr.back() == '0' && amtStr[amtStr.length()-2] != '.') {
-                        amtStr.pop_back();
-                    }
-                }
-                cout << Color::BRIGHT_GREEN << amtStr << Color::RESET;
-                // pad amount to 16 chars
-                for (size_t i = amtStr.length(); i < 16; ++i) cout << " ";
+    /**
+     * Time the bid table's operations over a million bids made from the
+     * loaded ones: inserts one at a time (growing from the default size),
+     * single and batched lookups of stored and missing ids, then a bulk
+     * load of the same bids into an empty table.
+     *
+     * @param hashTable the table holding the loaded bids
+     **/
+    void benchmarkBidTable(const BidTable *hashTable) {
+        vector<Bid> templates;
+        templates.reserve(hashTable->Size());
+        hashTable->ForEach([&templates](const Bid& bid) { templates.push_back(bid); });
+        if (templates.empty()) {
+            cout << Color::BRIGHT_RED << "Load bids before running the benchmark." << Color::RESET << endl;
+            return;
+        }
+        const size_t count = 1000000;
+        vector<Bid> bids = syntheticBids(templates, count, 100000000);
+        vector<Bid> missing = syntheticBids(templates, count, 1000000000);
+        vector<std::string_view> hits, misses;
+        for (size_t i = 0; i < count; ++i) {
+            hits.push_back(bids[i].bidId);
+            misses.push_back(missing[i].bidId);
+        }
+        vector<const Bid*> found(count);
+        size_t matched = 0;
+
+        string title = "Bid Table over " + std::to_string(count) + " Bids";
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "|  " << Color::BRIGHT_CYAN << title << Color::BRIGHT_BLUE;
+        for (size_t i = title.length(); i < 75; ++i) cout << " ";
+        cout << "|" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+        cout << Color::BRIGHT_YELLOW << "  Operation                          ms        ns/op" << Color::RESET << endl;
+
+        {
+            BidTable table;
+            auto started = std::chrono::steady_clock::now();
+            for (const Bid& bid : bids) {
+                table.Insert(bid);
+            }
+            printTiming("Insert", started, count);
 
-                cout << Color::MAGENTA << iter->bid.fund << Color::RESET << endl;
+            started = std::chrono::steady_clock::now();
+            for (const Bid& bid : bids) {
+                matched += !table.Search(bid.bidId).bidId.empty();
             }
-            iter = iter->next;
-        }
-    }
+            printTiming("Search hits", started, count);
 
-    cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
-}
+            started = std::chrono::steady_clock::now();
+            for (const Bid& bid : missing) {
+                matched += !table.Search(bid.bidId).bidId.empty();
+            }
+            printTiming("Search misses", started, count);
 
-/**
-* Remove a bid by bidId.
-*
-* Process:
-*  - Compute the bucket index from the bidId (string hash).
-*  - If the bucket is empty; head empty and no chain, return.
-*  - If the head holds the target bid:
-*      - If no chain; clear the head node to mark the bucket empty.
-*      - If there is a chain; promote the first chained node into the head then delete it.
-*      - Otherwise, walk the chain; unlink the matching node if found.
-*/
-void HashTable::Remove(const std::string& bidId) {
-    // map the bidId to a bucket index with string hash
-    unsigned int bucket_index = hash(bidId);
-    Node *head = &nodes[bucket_index];
+            started = std::chrono::steady_clock::now();
+            table.SearchBatch(hits, found);
+            printTiming("SearchBatch hits", started, count);
 
-    // empty bucket; nothing to remove
-    if (head->key == UINT_MAX && head->next == nullptr) {
-        return;
-    }
-    // head node matches; head holds the target bid
-    if (head->key != UINT_MAX && head->bid.bidId == bidId) {
-        if (head->next == nullptr) {
-            // only head in the bucket; clear; mark bucket empty
-            head->key = UINT_MAX;
-            head->bid = Bid();
-            head->next = nullptr;
-        } else {
-            // promote 1st chained node to head, then delete the node
-            Node *nextBucket = head->next;
-            head->bid = nextBucket->bid;
-            head->next = nextBucket->next;
-            head->key = nextBucket->key; // maintain invariant: head->key must equal its bucket index
-            delete nextBucket;
+            started = std::chrono::steady_clock::now();
+            table.SearchBatch(misses, found);
+            printTiming("SearchBatch misses", started, count);
         }
-        return;
-    }
-    // walk chain; search for match
-    Node *prev_bucket = head;
-    Node *curr_bucket = head->next;
-    while (curr_bucket != nullptr) {
-        if (curr_bucket->bid.bidId == bidId) {
-            prev_bucket->next = curr_bucket->next; // unlink node
-            delete curr_bucket; // free memory
-            return;
+        {
+            BidTable table;
+            vector<Bid> loaded = bids;
+            auto started = std::chrono::steady_clock::now();
+            table.BulkLoad(std::move(loaded));
+            printTiming("BulkLoad", started, count);
         }
-        prev_bucket = curr_bucket;
-        curr_bucket = curr_bucket->next;
-    }
-}
 
+        // the same bids keyed by their numeric id: eight-byte keys are
+        // kept in the nodes themselves rather than next to the bids
+        cout << Color::BRIGHT_YELLOW << "  HashTable<uint64_t, Bid>, keys in the nodes" << Color::RESET << endl;
+        vector<uint64_t> keys, missingKeys;
+        for (size_t i = 0; i < count; ++i) {
+            keys.push_back(std::stoull(bids[i].bidId));
+            missingKeys.push_back(std::stoull(missing[i].bidId));
+        }
+        {
+            HashTable<uint64_t, Bid> table;
+            auto started = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; ++i) {
+                table.insert(keys[i], bids[i]);
+            }
+            printTiming("Insert", started, count);
 
-/**
-* Search for a bid by bidId.
-*
-* Process:
-*  - Hash the bidId (string-based hash) to find its bucket index.
-*  - Check the head node at that bucket; if it matches, return it.
-*  - Otherwise, walk down the linked list chain for that bucket:
-*      - If a matching bidId is found, return the bid.
-*      - Continue until the end of the chain.
-*  - If no match is found, return default-constructed Bid
-*    (with bidId == "") signifying "not found".
-*
-* @param bidId The bid identifier string to look up.
-* @return The matching Bid if found, or an empty Bid otherwise.
-*/
-    Bid HashTable::Search(const std::string& bidId) {
-        Bid bid; // default-constructed Bid; "not found" result
-        // map the bidId to a bucket index with string hash
-        unsigned int bucket_index = hash(bidId);
+            started = std::chrono::steady_clock::now();
+            for (uint64_t key : keys) {
+                matched += table.find(key) != nullptr;
+            }
+            printTiming("Find hits", started, count);
+
+            started = std::chrono::steady_clock::now();
+            for (uint64_t key : missingKeys) {
+                matched += table.find(key) != nullptr;
+            }
+            printTiming("Find misses", started, count);
+
+            started = std::chrono::steady_clock::now();
+            table.findBatch(std::span<const uint64_t>(keys), std::span<const Bid*>(found));
+            printTiming("FindBatch hits", started, count);
 
-        // if entry found for the key
-        Node *head= &nodes[bucket_index];
+            started = std::chrono::steady_clock::now();
+            table.findBatch(std::span<const uint64_t>(missingKeys), std::span<const Bid*>(found));
+            printTiming("FindBatch misses", started, count);
 
-        // check the bucket head first
-        if (head->key != UINT_MAX && head->bid.bidId == bidId) {
-            return head->bid;
+            started = std::chrono::steady_clock::now();
+            for (uint64_t key : keys) {
+                table.erase(key);
+            }
+            printTiming("Erase", started, count);
+            matched += table.size();
         }
-        // walk chain for matches
-        const Node *curr_bucket = head ->next;
-        while (curr_bucket != nullptr) {
-            if (curr_bucket->bid.bidId == bidId) {
-                return curr_bucket->bid;
+        {
+            HashTable<uint64_t, Bid> table;
+            vector<pair<uint64_t, Bid>> entries;
+            entries.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                entries.emplace_back(keys[i], bids[i]);
             }
-            curr_bucket = curr_bucket->next;
+            auto started = std::chrono::steady_clock::now();
+            table.bulkLoad(std::move(entries));
+            printTiming("BulkLoad", started, count);
         }
-        return bid; // not found
-    }
 
-
-    //============================================================================
-    // Static methods used for testing
-    //============================================================================
+        // every hit found in both tables, no miss found, nothing left after the erases
+        if (matched != 2 * count) {
+            cout << Color::BRIGHT_RED << "  lookups found " << matched << " of " << 2 * count << " bids" << Color::RESET << endl;
+        }
+        printBidTableFooter();
+    }
 
     /**
-     * Display the bid information to the console (std::out)
-     *
-     * @param bid struct containing the bid info
+     * The split loop csv::Parser used before quoted fields were unescaped:
+     * a quote only toggles whether commas split, and every field is
+     * copied out, quotes and all. Kept as the baseline of the CSV benchmark.
      **/
-    void displayBid(Bid bid) {
-        cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-                << bid.fund << endl;
-        return;
+    size_t splitFieldsBaseline(std::string_view record, vector<string>& fields) {
+        fields.clear();
+        bool quoted = false;
+        size_t tokenStart = 0;
+        for (size_t i = 0; i != record.length(); i++) {
+            if (record[i] == '"') {
+                quoted = !quoted;
+            } else if (record[i] == ',' && !quoted) {
+                fields.emplace_back(record.substr(tokenStart, i - tokenStart));
+                tokenStart = i + 1;
+            }
+        }
+        fields.emplace_back(record.substr(tokenStart));
+        return fields.size();
     }
 
     /**
-     * Load a CSV file containing bids into a container
+     * Time the CSV layer over a file of a million records, written to the
+     * temp directory from the newest file csvPath names (its rows repeated):
+     * splitting the records with the baseline loop and the tokenizers, in
+     * the default dialect and with the same characters read at run time;
+     * opening the file eager, lazy and indexed (building file.idx, then
+     * reusing it); reading the last column by name, by ColumnHandle and by
+     * position; and deletes and inserts in the middle of the rows. The file
+     * and its index are removed afterwards.
      *
-     * @param csvPath the path to the CSV file to load
-     * @return a container holding all the bids read
+     * @param csvPath the file, directory or glob the bids are loaded from
      **/
-    void loadBids(string csvPath, HashTable *hashTable) {
-        // initialize the CSV Parser using the given path
-        csv::Parser file = csv::Parser(csvPath);
+    void benchmarkCsvParsing(const string& csvPath) {
+        namespace fs = std::filesystem;
+        vector<string> sources = expandCsvPaths(csvPath);
+        const size_t count = 1000000;
+        string path = (fs::temp_directory_path() / "csv_benchmark.csv").string();
+        string indexPath = path + ".idx";
+        vector<string> header;
+        try {
+            csv::Parser source(sources.empty() ? csvPath : sources.back());
+            if (source.rowCount() == 0) {
+                throw csv::Error("no rows in " + source.getFileName());
+            }
+            header = source.getHeader();
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            for (size_t i = 0; i < header.size(); ++i) {
+                out << (i ? "," : "") << header[i];
+            }
+            out << "\n";
+            for (size_t i = 0; i < count; ++i) {
+                out << source[i % source.rowCount()] << "\n";
+            }
+            if (!out.good()) {
+                throw csv::Error("cannot write " + path);
+            }
+        } catch (const csv::Error& e) {
+            cout << Color::BRIGHT_RED << "Cannot benchmark the CSV parser: " << e.what() << Color::RESET << endl;
+            std::remove(path.c_str());
+            return;
+        }
+        std::remove(indexPath.c_str());
+
+        // the records of the file, without its header
+        string text;
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::ostringstream contents;
+            contents << in.rdbuf();
+            text = contents.str();
+        }
+        vector<std::string_view> records;
+        size_t start = 0;
+        bool first = true;
+        while (start < text.size()) {
+            csv::RecordState state;
+            const char *newline = csv::findRecordEnd(text.data() + start, text.size() - start, state, csv::Dialect());
+            size_t end = newline ? newline - text.data() : text.size();
+            if (!first) {
+                records.emplace_back(text.data() + start, end - start);
+            }
+            first = false;
+            start = end + 1;
+        }
 
-        // display loading info in a themed box
-        size_t colCount = file.getHeader().size();
-        size_t rowCount = file.rowCount();
-        const size_t boxWidth = 42; // content width after "| "
+        string title = "CSV Parsing over " + std::to_string(count) + " Records";
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "|  " << Color::BRIGHT_CYAN << title << Color::BRIGHT_BLUE;
+        for (size_t i = title.length(); i < 75; ++i) cout << " ";
+        cout << "|" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+        cout << Color::BRIGHT_YELLOW << "  Operation                          ms        ns/op" << Color::RESET << endl;
+
+        size_t sink = 0;
+        {
+            vector<string> fields;
+            auto started = std::chrono::steady_clock::now();
+            for (std::string_view record : records) {
+                sink += splitFieldsBaseline(record, fields);
+            }
+            printTiming("Split, baseline loop", started, count);
 
-        cout << Color::BRIGHT_BLUE << "+-------------------------------------------+" << Color::RESET << endl;
-        cout << Color::BRIGHT_BLUE << "|            " << Color::BRIGHT_CYAN << "Loading CSV Data" << Color::BRIGHT_BLUE << "               |" << Color::RESET << endl;
-        cout << Color::BRIGHT_BLUE << "+-------------------------------------------+" << Color::RESET << endl;
+            string scratch;
+            started = std::chrono::steady_clock::now();
+            for (std::string_view record : records) {
+                csv::splitFields(record, scratch, [&sink](std::string_view field) { sink += field.size(); });
+            }
+            printTiming("splitFields", started, count);
+
+            // in place: each pass gets a fresh copy of the records
+            string copy = text;
+            started = std::chrono::steady_clock::now();
+            for (std::string_view record : records) {
+                csv::splitFieldsInPlace(&copy[record.data() - text.data()], record.size(),
+                                        [&sink](std::string_view field) { sink += field.size(); });
+            }
+            printTiming("splitFieldsInPlace", started, count);
+
+            // the same rules with the characters read at run time, as for any other dialect
+            copy = text;
+            csv::detail::DialectTraits<true, false> runtime{',', '"', '"'};
+            started = std::chrono::steady_clock::now();
+            for (std::string_view record : records) {
+                csv::splitFieldsInPlace(runtime, &copy[record.data() - text.data()], record.size(),
+                                        [&sink](std::string_view field) { sink += field.size(); });
+            }
+            printTiming("In place, run-time chars", started, count);
+        }
 
-        // File row
-        string fileContent = "File: " + csvPath;
-        cout << Color::BRIGHT_BLUE << "| " << Color::BRIGHT_YELLOW << "File: " << Color::RESET << csvPath;
-        for (size_t i = fileContent.length(); i < boxWidth; ++i) cout << " ";
-        cout << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+        const string& name = header.back();
+        const unsigned int position = header.size() - 1;
+        cout << Color::BRIGHT_YELLOW << "  Parser modes; reads of the column " << name << Color::RESET << endl;
+        try {
+            {
+                auto started = std::chrono::steady_clock::now();
+                csv::Parser file(path, csv::eFILE, csv::Dialect(), csv::eEAGER);
+                printTiming("Open eager", started, count);
+
+                started = std::chrono::steady_clock::now();
+                for (unsigned int row = 0; row < file.rowCount(); ++row) {
+                    sink += file[row][name].size();
+                }
+                printTiming("Read by name", started, count);
 
-        // Columns row
-        string colContent = "Columns: " + to_string(colCount);
-        cout << Color::BRIGHT_BLUE << "| " << Color::BRIGHT_YELLOW << "Columns: " << Color::RESET << colCount;
-        for (size_t i = colContent.length(); i < boxWidth; ++i) cout << " ";
-        cout << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+                csv::ColumnHandle column = file.column(name);
+                started = std::chrono::steady_clock::now();
+                for (unsigned int row = 0; row < file.rowCount(); ++row) {
+                    sink += file[row][column].size();
+                }
+                printTiming("Read by ColumnHandle", started, count);
 
-        // Rows row
-        string rowContent = "Rows: " + to_string(rowCount);
-        cout << Color::BRIGHT_BLUE << "| " << Color::BRIGHT_YELLOW << "Rows: " << Color::RESET << rowCount;
-        for (size_t i = rowContent.length(); i < boxWidth; ++i) cout << " ";
-        cout << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+                started = std::chrono::steady_clock::now();
+                for (unsigned int row = 0; row < file.rowCount(); ++row) {
+                    sink += file[row].at_unchecked(position).size();
+                }
+                printTiming("Read by position", started, count);
+
+                // a thousand rows out of the middle, then put back
+                const unsigned int edits = 1000;
+                unsigned int middle = file.rowCount() / 2;
+                vector<string> values;
+                for (unsigned int i = 0; i < header.size(); ++i) {
+                    values.emplace_back(file[middle].at_unchecked(i));
+                }
+                started = std::chrono::steady_clock::now();
+                for (unsigned int i = 0; i < edits; ++i) {
+                    file.deleteRow(middle);
+                }
+                for (unsigned int i = 0; i < edits; ++i) {
+                    file.addRow(middle, values);
+                }
+                printTiming("Delete + insert mid-file", started, 2 * edits);
 
-        cout << Color::BRIGHT_BLUE << "+-------------------------------------------+" << Color::RESET << endl;
+                started = std::chrono::steady_clock::now();
+                for (unsigned int row = 0; row < file.rowCount(); ++row) {
+                    sink += file[row][column].size();
+                }
+                printTiming("Read after the edits", started, count);
+            }
 
-        try {
-            // loop to read rows of a CSV file
-            for (unsigned int i = 0; i < file.rowCount(); i++) {
-                // Create a data structure and add to the collection of bids
-                Bid bid;
-                bid.bidId = file[i][1];
-                bid.title = file[i][0];
-                bid.fund = file[i][8];
-                bid.amount = strToDouble(file[i][4], '$');
+            // the lazy modes tokenize each row on its first read
+            const std::pair<const char*, csv::LoadMode> lazyModes[] = {
+                {"lazy", csv::eLAZY}, {"indexed, building", csv::eINDEXED}, {"indexed, reusing", csv::eINDEXED}};
+            for (const auto& mode : lazyModes) {
+                auto started = std::chrono::steady_clock::now();
+                csv::Parser file(path, csv::eFILE, csv::Dialect(), mode.second);
+                printTiming(string("Open ") + mode.first, started, count);
+
+                csv::ColumnHandle column = file.column(name);
+                started = std::chrono::steady_clock::now();
+                for (unsigned int row = 0; row < file.rowCount(); ++row) {
+                    sink += file[row][column].size();
+                }
+                printTiming(string("Read, ") + mode.first, started, count);
+            }
+        } catch (const csv::Error& e) {
+            cout << Color::BRIGHT_RED << "  " << e.what() << Color::RESET << endl;
+        }
+        volatile size_t keep = sink; // the fields must not be optimized away
+        (void)keep;
+
+        std::remove(indexPath.c_str());
+        std::remove(path.c_str());
+        printBidTableFooter();
+    }
+
+    /**
+     * Whether a range query on table visits exactly the bids a linear scan
+     * finds with lo <= key <= hi, in key order: amounts for double keys,
+     * close dates for int keys
+     **/
+    template <typename Key>
+    bool rangeMatchesScan(BidTable& table, Key lo, Key hi) {
+        Key Bid::*field;
+        vector<Bid> found;
+        auto collect = [&found](const Bid& bid) { found.push_back(bid); };
+        if constexpr (std::is_same_v<Key, double>) {
+            field = &Bid::amount;
+            table.ForEachInAmountRange(lo, hi, collect);
+        } else {
+            field = &Bid::closeDate;
+            table.ForEachInCloseDateRange(lo, hi, collect);
+        }
+        for (size_t i = 1; i < found.size(); ++i) {
+            if (found[i].*field < found[i - 1].*field) return false;
+        }
+
+        vector<string> visited, expected;
+        for (const Bid& bid : found) {
+            visited.push_back(bid.bidId);
+        }
+        table.ForEach([&](const Bid& bid) {
+            if (!(bid.*field < lo) && !(hi < bid.*field)) expected.push_back(bid.bidId);
+        });
+        std::sort(visited.begin(), visited.end());
+        std::sort(expected.begin(), expected.end());
+        return visited == expected;
+    }
 
-                //cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
+    /**
+     * Check the amount and close date range indexes against linear scans
+     * on a copy of the loaded bids: once as first built, then after
+     * inserting half as many new bids again (merging the delta buffer),
+     * changing the amount and close date of every fifth bid, and removing
+     * every third bid (tombstones). Each step is timed; a step where any
+     * range disagrees with its scan is reported in red.
+     *
+     * @param hashTable the table holding the loaded bids
+     **/
+    void checkRangeIndexes(const BidTable *hashTable) {
+        vector<Bid> bids;
+        bids.reserve(hashTable->Size());
+        hashTable->ForEach([&bids](const Bid& bid) { bids.push_back(bid); });
+        if (bids.empty()) {
+            cout << Color::BRIGHT_RED << "Load bids before checking the range indexes." << Color::RESET << endl;
+            return;
+        }
 
-                // push this bid to the end
-                hashTable->Insert(bid);
+        string title = "Range Indexes over " + std::to_string(bids.size()) + " Bids";
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "|  " << Color::BRIGHT_CYAN << title << Color::BRIGHT_BLUE;
+        for (size_t i = title.length(); i < 75; ++i) cout << " ";
+        cout << "|" << Color::RESET << endl;
+        cout << Color::BRIGHT_BLUE << "+-----------------------------------------------------------------------------+" << Color::RESET << endl;
+
+        // everything, the middle half, one value, nothing; and for dates also the median bid's month
+        vector<double> amounts;
+        vector<int> dates;
+        for (const Bid& bid : bids) {
+            amounts.push_back(bid.amount);
+            dates.push_back(bid.closeDate);
+        }
+        std::sort(amounts.begin(), amounts.end());
+        std::sort(dates.begin(), dates.end());
+        size_t n = bids.size();
+        int month = dates[n / 2] / 100 * 100;
+        const vector<pair<double, double>> amountRanges = {
+            {amounts.front(), amounts.back()}, {amounts[n / 4], amounts[3 * n / 4]},
+            {amounts[n / 2], amounts[n / 2]}, {amounts.back() + 1, amounts.back() + 2}};
+        const vector<pair<int, int>> dateRanges = {
+            {dates.front(), dates.back()}, {dates[n / 4], dates[3 * n / 4]},
+            {month + 1, month + 31}, {dates.back() + 1, dates.back() + 2}};
+        auto rangesMatch = [&](BidTable& table) {
+            bool matched = true;
+            for (const auto& [lo, hi] : amountRanges) {
+                matched = rangeMatchesScan(table, lo, hi) && matched;
             }
-        } catch (csv::Error &e) {
-            std::cerr << e.what() << std::endl;
+            for (const auto& [from, to] : dateRanges) {
+                matched = rangeMatchesScan(table, from, to) && matched;
+            }
+            return matched;
+        };
+
+        BidTable table;
+        table.BulkLoad(bids);
+        auto started = std::chrono::steady_clock::now();
+        printCheck("Build and query", started, rangesMatch(table));
+
+        started = std::chrono::steady_clock::now();
+        vector<Bid> added = syntheticBids(bids, n / 2, 1000000000);
+        for (size_t i = 0; i < added.size(); ++i) {
+            added[i].amount += (i % 100) * 0.01;
+            table.Insert(added[i]);
+        }
+        printCheck("Insert " + std::to_string(added.size()) + " new bids", started, rangesMatch(table));
+
+        started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i += 5) {
+            Bid changed = bids[i];
+            changed.amount = changed.amount * 2 + 1;
+            changed.closeDate = month + 15;
+            table.Insert(changed);
         }
+        printCheck("Update every fifth bid", started, rangesMatch(table));
+
+        started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i += 3) {
+            table.Remove(bids[i].bidId);
+        }
+        printCheck("Remove every third bid", started, rangesMatch(table) && table.Size() == n + added.size() - (n + 2) / 3);
+        printBidTableFooter();
     }
 
     /**
@@ -487,6 +2133,21 @@ void HashTable::Remove(const std::string& bidId) {
         return atof(str.c_str());
     }
 
+    /**
+     * Convert an export date (m/d/yyyy, ex 6/9/2014) to yyyymmdd
+     * so dates order as plain integers.
+     *
+     * @return the date as yyyymmdd, or 0 when it cannot be read
+     **/
+    int parseDate(const string& date) {
+        int month, day, year;
+        if (sscanf(date.c_str(), "%d/%d/%d", &month, &day, &year) != 3 ||
+            month < 1 || month > 12 || day < 1 || day > 31) {
+            return 0;
+        }
+        return year * 10000 + month * 100 + day;
+    }
+
 /**
 *    Purpose: Prevents menu from printing immediately, till user presses Enter
 *   - Giving the user time to read the previous output.
@@ -533,10 +2194,10 @@ void HashTable::Remove(const std::string& bidId) {
         clock_t ticks;
 
         // define a hash table to hold all the bids
-        HashTable *bidTable;
+        BidTable *bidTable;
 
         Bid bid;
-        bidTable = new HashTable();
+        bidTable = new BidTable();
 
         int choice = 0;
         while (choice != 9) {
@@ -551,6 +2212,17 @@ void HashTable::Remove(const std::string& bidId) {
             cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[2]" << Color::RESET << " Display All Bids                    " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
             cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[3]" << Color::RESET << " Find Bid                            " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
             cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[4]" << Color::RESET << " Remove Bid                          " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[5]" << Color::RESET << " Load Bids (pipelined)               " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[6]" << Color::RESET << " Find Bids by Fund                   " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[7]" << Color::RESET << " Totals by Fund                      " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[8]" << Color::RESET << " Totals by Department                " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[10]" << Color::RESET << " Top 50 Winning Bids                " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[11]" << Color::RESET << " Benchmark Hash Functions           " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[12]" << Color::RESET << " Check Sharded Table                " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[13]" << Color::RESET << " Benchmark Table Operations         " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[14]" << Color::RESET << " Benchmark CSV Parsing              " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[15]" << Color::RESET << " Find Bids by Amount Range          " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
+            cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[16]" << Color::RESET << " Check Range Indexes                " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
             cout << Color::BRIGHT_BLUE << "|                                           |" << Color::RESET << endl;
             cout << Color::BRIGHT_BLUE << "|   " << Color::BRIGHT_YELLOW << "[9]" << Color::RESET << " Exit                                " << Color::BRIGHT_BLUE << "|" << Color::RESET << endl;
             cout << Color::BRIGHT_BLUE << "|                                           |" << Color::RESET << endl;
@@ -582,17 +2254,20 @@ void HashTable::Remove(const std::string& bidId) {
 
                 case 1:
                     {
-                        // initialize timer variable before loading bids
+                        // initialize timer variables before loading bids;
+                        // clock() sums cpu time over all loader threads, so also time the wall clock
                         ticks = clock();
+                        auto started = std::chrono::steady_clock::now();
 
-                        // method call to load the bids
-                        loadBids(csvPath, bidTable);
+                        // method call to load the bids (a file, a directory or a glob of monthly exports)
+                        loadBidFiles(csvPath, bidTable);
 
                         // calculate elapsed time and display the  result
                         ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+                        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
                         cout << Color::BRIGHT_GREEN << "Load complete." << Color::RESET << endl;
-                        cout << Color::MAGENTA << "time: " << ticks << " clock ticks" << Color::RESET << endl;
-                        cout << Color::MAGENTA << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << Color::RESET << endl;
+                        cout << Color::MAGENTA << "time: " << ticks << " clock ticks (cpu, all threads)" << Color::RESET << endl;
+                        cout << Color::MAGENTA << "time: " << elapsed.count() << " seconds (wall)" << Color::RESET << endl;
                     }
                     // pause to allow user to read output before menu redisplays
                     pauseForUser();
@@ -631,6 +2306,154 @@ void HashTable::Remove(const std::string& bidId) {
                     pauseForUser();
                     break;
 
+                case 5:
+                    {
+                        // initialize timer variables before loading bids;
+                        // clock() sums cpu time over all loader threads, so also time the wall clock
+                        ticks = clock();
+                        auto started = std::chrono::steady_clock::now();
+
+                        // load through the reader/tokenizer/inserter pipeline
+                        loadBidsPipelined(csvPath, bidTable);
+
+                        // calculate elapsed time and display the  result
+                        ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+                        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+                        cout << Color::BRIGHT_GREEN << "Load complete." << Color::RESET << endl;
+                        cout << Color::MAGENTA << "time: " << ticks << " clock ticks (cpu, all threads)" << Color::RESET << endl;
+                        cout << Color::MAGENTA << "time: " << elapsed.count() << " seconds (wall)" << Color::RESET << endl;
+                    }
+                    // pause to allow user to read output before menu redisplays
+                    pauseForUser();
+                    break;
+
+                case 6:
+                    {
+                        string fund;
+                        cout << Color::BRIGHT_CYAN << "Enter fund: " << Color::RESET;
+                        cout.flush();
+                        cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                        getline(cin, fund);
+                        cin.unget(); // leave the newline for pauseForUser
+
+                        ticks = clock();
+
+                        // collected through the fund index, no table scan
+                        vector<Bid> matches;
+                        bidTable->ForEachInFund(fund, [&matches](const Bid& match) { matches.push_back(match); });
+
+                        ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+                        printBidTableHeader(static_cast<unsigned int>(matches.size()), "Fund " + fund);
+                        for (const Bid& match : matches) {
+                            printBidTableRow(match);
+                        }
+                        printBidTableFooter();
+                        cout << Color::MAGENTA << "time: " << ticks << " clock ticks" << Color::RESET << endl;
+                    }
+                    pauseForUser();
+                    break;
+
+                case 7:
+                case 8:
+                    {
+                        GroupBy groupBy = (choice == 7) ? GroupBy::FUND : GroupBy::DEPARTMENT;
+                        auto started = std::chrono::steady_clock::now();
+
+                        // snapshot the amounts as a column, then aggregate it
+                        BidColumns columns = bidTable->Columns(groupBy);
+                        vector<Aggregate> aggregates = aggregateColumns(columns);
+
+                        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+                        printAggregateTable(choice == 7 ? "Winning Bids by Fund" : "Winning Bids by Department",
+                                            columns, aggregates);
+                        cout << Color::MAGENTA << "time: " << elapsed.count() << " seconds (wall)" << Color::RESET << endl;
+                    }
+                    pauseForUser();
+                    break;
+
+                case 10:
+                    {
+                        ticks = clock();
+
+                        // bounded heaps per worker, no copy or sort of the whole table
+                        vector<Bid> top = bidTable->TopK(50, &Bid::amount);
+
+                        ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+                        printBidTableHeader(static_cast<unsigned int>(top.size()), "Top Winning Bids");
+                        for (const Bid& match : top) {
+                            printBidTableRow(match);
+                        }
+                        printBidTableFooter();
+                        cout << Color::MAGENTA << "time: " << ticks << " clock ticks" << Color::RESET << endl;
+                    }
+                    pauseForUser();
+                    break;
+
+                case 11:
+                    benchmarkHashPolicies(bidTable);
+                    pauseForUser();
+                    break;
+
+                case 12:
+                    checkShardedTable(bidTable);
+                    pauseForUser();
+                    break;
+
+                case 13:
+                    benchmarkBidTable(bidTable);
+                    pauseForUser();
+                    break;
+
+                case 14:
+                    benchmarkCsvParsing(csvPath);
+                    pauseForUser();
+                    break;
+
+                case 15:
+                    {
+                        double lowest = 0, highest = 0;
+                        cout << Color::BRIGHT_CYAN << "Enter lowest amount: " << Color::RESET;
+                        cout.flush();
+                        cin >> lowest;
+                        if (!cin.fail()) {
+                            cout << Color::BRIGHT_CYAN << "Enter highest amount: " << Color::RESET;
+                            cout.flush();
+                            cin >> highest;
+                        }
+                        if (cin.fail()) {
+                            cout << Color::BRIGHT_RED << "Error: Invalid amount." << Color::RESET << endl;
+                            cin.clear();
+                            pauseForUser();
+                            break;
+                        }
+
+                        ticks = clock();
+
+                        // collected through the amount index, lowest amount first
+                        vector<Bid> matches;
+                        bidTable->ForEachInAmountRange(lowest, highest, [&matches](const Bid& match) { matches.push_back(match); });
+
+                        ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+                        char range[64];
+                        snprintf(range, sizeof(range), "Amounts $%.2f to $%.2f", lowest, highest);
+                        printBidTableHeader(static_cast<unsigned int>(matches.size()), range);
+                        for (const Bid& match : matches) {
+                            printBidTableRow(match);
+                        }
+                        printBidTableFooter();
+                        cout << Color::MAGENTA << "time: " << ticks << " clock ticks" << Color::RESET << endl;
+                    }
+                    pauseForUser();
+                    break;
+
+                case 16:
+                    checkRangeIndexes(bidTable);
+                    pauseForUser();
+                    break;
+
                 case 9:
                     // default case for exit
                     break;
@@ -0,0 +1,692 @@
+#ifndef     _HASHTABLE_HPP_
+# define    _HASHTABLE_HPP_
+
+# include <algorithm>
+# include <bit>
+# include <climits>
+# include <cstddef>
+# include <functional>
+# include <memory>
+# include <span>
+# include <stdexcept>
+# include <thread>
+# include <type_traits>
+# include <utility>
+# include <vector>
+
+// items per worker below which another thread costs more than it saves
+inline constexpr std::size_t MIN_ITEMS_PER_WORKER = 4096;
+
+/**
+ * Hint the CPU to start pulling addr into cache.
+ * A no-op on compilers without __builtin_prefetch.
+ */
+inline void prefetch(const void *addr) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr);
+#else
+    (void)addr;
+#endif
+}
+
+/**
+ * Split [0, count) into contiguous ranges and run fn(begin, end) on
+ * each range from its own thread; the calling thread takes the last one.
+ * Small inputs run entirely on the calling thread.
+ */
+template <typename Fn>
+void parallelFor(std::size_t count, Fn fn) {
+    std::size_t workers = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                                std::max<std::size_t>(1, count / MIN_ITEMS_PER_WORKER));
+    std::vector<std::thread> threads;
+    for (std::size_t worker = 0; worker + 1 < workers; ++worker) {
+        threads.emplace_back(fn, count * worker / workers, count * (worker + 1) / workers);
+    }
+    fn(count * (workers - 1) / workers, count);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Chained hash table from K to V.
+ *
+ * The buckets are a power-of-two array of head nodes, picked by masking
+ * the hash, and collisions chain through nodes kept in one pool and
+ * linked by 32-bit index. Values live apart from the nodes in a dense
+ * payload array. A stored value keeps its slot (payload index) until it
+ * is erased, since rehashing only relinks nodes, so callers can keep
+ * side indexes keyed by slot.
+ *
+ * The node layout is picked at compile time from the key type:
+ *  - small trivially copyable keys (integers, enums, ids of up to eight
+ *    bytes) sit in the node itself, so a probe compares keys without
+ *    touching the payload and a rehash just rehashes the node's key;
+ *  - any other key (ex std::string) sits next to its value, and the node
+ *    keeps the key's full hash instead, so a probe only reads a key once
+ *    the hashes match and a rehash never hashes a key again.
+ * Either way a node is at most 16 bytes, four to a cache line.
+ *
+ * With a transparent Hash and KeyEq (ex std::equal_to<>), find, erase
+ * and findBatch take any key type the two accept, such as string_view
+ * lookups into std::string keys.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEq = std::equal_to<K>, typename Alloc = std::allocator<V>>
+class HashTable {
+public:
+    // keys stored in the nodes instead of their hashes
+    static constexpr bool INLINE_KEYS = std::is_trivially_copyable_v<K> && sizeof(K) <= sizeof(std::size_t);
+
+    static constexpr unsigned int DEFAULT_SIZE = 256;
+
+    // slot returned for a key that is not stored
+    static constexpr unsigned int NPOS = UINT_MAX;
+
+private:
+    // payload index of an empty bucket head
+    static constexpr unsigned int EMPTY = UINT_MAX;
+
+    // next link of the last node in a chain
+    static constexpr unsigned int NO_NODE = UINT_MAX;
+
+    // lookups findBatch keeps in flight at once
+    static constexpr std::size_t SEARCH_GROUP_SIZE = 16;
+
+    struct HashedNode {
+        std::size_t hash = 0;         // full hash of the key
+        unsigned int payload = EMPTY; // index into payloads, EMPTY if none
+        unsigned int next = NO_NODE;  // index into chainNodes, NO_NODE if last
+    };
+
+    struct KeyedNode {
+        K key;
+        unsigned int payload = EMPTY;
+        unsigned int next = NO_NODE;
+    };
+
+    struct Entry {
+        K key;
+        V value;
+    };
+
+    using Node = std::conditional_t<INLINE_KEYS, KeyedNode, HashedNode>;
+    using Payload = std::conditional_t<INLINE_KEYS, V, Entry>;
+
+    template <typename T>
+    using Rebind = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+public:
+    explicit HashTable(unsigned int size = DEFAULT_SIZE, const Alloc& alloc = Alloc())
+        : nodes(Rebind<Node>(alloc)), chainNodes(Rebind<Node>(alloc)),
+          payloads(Rebind<Payload>(alloc)), freePayloads(Rebind<unsigned int>(alloc)),
+          tableSize(std::bit_ceil(size == 0 ? DEFAULT_SIZE : size)) {
+        nodes.resize(tableSize);
+    }
+
+    unsigned int size() const {
+        return count;
+    }
+
+    unsigned int bucketCount() const {
+        return tableSize;
+    }
+
+    // bucket a key hashes to
+    template <typename Lookup>
+    unsigned int bucket(const Lookup& key) const {
+        return bucketOf(hasher(key));
+    }
+
+    V& value(unsigned int slot) {
+        return valueOf(payloads[slot]);
+    }
+
+    const V& value(unsigned int slot) const {
+        return valueOf(payloads[slot]);
+    }
+
+    /**
+     * Find the slot of a key, storing V(args...) for it when it is
+     * missing; args are left alone when the key is already stored. Once
+     * there are as many values as buckets the table is first doubled, so
+     * chains stay short however many keys stream in.
+     *
+     * @return the slot, and whether the key was just added
+     */
+    template <typename... Args>
+    std::pair<unsigned int, bool> tryEmplace(const K& key, Args&&... args) {
+        if (count >= tableSize) {
+            rehash(tableSize * 2);
+        }
+        std::size_t fullHash = hasher(key);
+        Node *head = &nodes[bucketOf(fullHash)];
+        if (head->payload == EMPTY) {
+            setKey(*head, fullHash, key);
+            head->payload = allocatePayload(key, std::forward<Args>(args)...);
+            head->next = NO_NODE;
+            count++;
+            return {head->payload, true};
+        }
+        Node *curr = head;
+        while (true) {
+            if (matches(*curr, fullHash, key)) {
+                return {curr->payload, false};
+            }
+            if (curr->next == NO_NODE) {
+                break;
+            }
+            curr = &chainNodes[curr->next];
+        }
+        // append to the end of the chain; the tail is found again by index
+        // since allocateNode may move the pool
+        unsigned int tail = (curr == head) ? NO_NODE : static_cast<unsigned int>(curr - chainNodes.data());
+        unsigned int payload = allocatePayload(key, std::forward<Args>(args)...);
+        unsigned int link = allocateNode(fullHash, key, payload);
+        (tail == NO_NODE ? *head : chainNodes[tail]).next = link;
+        count++;
+        return {payload, true};
+    }
+
+    // store item under key, replacing any value already there
+    void insert(const K& key, V item) {
+        auto [slot, inserted] = tryEmplace(key, std::move(item));
+        if (!inserted) {
+            value(slot) = std::move(item);
+        }
+    }
+
+    // slot of a key, or NPOS
+    template <typename Lookup>
+    unsigned int findSlot(const Lookup& key) const {
+        std::size_t fullHash = hasher(key);
+        const Node *node = &nodes[bucketOf(fullHash)];
+        if (node->payload == EMPTY) {
+            return NPOS;
+        }
+        for (; node != nullptr; node = follow(node->next)) {
+            if (matches(*node, fullHash, key)) {
+                return node->payload;
+            }
+        }
+        return NPOS;
+    }
+
+    template <typename Lookup>
+    const V *find(const Lookup& key) const {
+        unsigned int slot = findSlot(key);
+        return slot == NPOS ? nullptr : &value(slot);
+    }
+
+    template <typename Lookup>
+    V *find(const Lookup& key) {
+        unsigned int slot = findSlot(key);
+        return slot == NPOS ? nullptr : &value(slot);
+    }
+
+    /**
+     * Erase a key. beforeErase(slot) runs while the value is still
+     * stored, so side indexes can drop it. A head node that goes away is
+     * replaced by the first chained node; only node fields move, the
+     * values keep their slots.
+     *
+     * @return whether the key was stored
+     */
+    template <typename Lookup, typename BeforeErase>
+    bool erase(const Lookup& key, BeforeErase beforeErase) {
+        std::size_t fullHash = hasher(key);
+        Node *head = &nodes[bucketOf(fullHash)];
+        if (head->payload == EMPTY) {
+            return false;
+        }
+        if (matches(*head, fullHash, key)) {
+            beforeErase(head->payload);
+            releasePayload(head->payload);
+            if (head->next == NO_NODE) {
+                head->payload = EMPTY;
+            } else {
+                unsigned int next = head->next;
+                *head = chainNodes[next];
+                releaseNode(next);
+            }
+            count--;
+            return true;
+        }
+        Node *prev = head;
+        Node *curr = follow(head->next);
+        while (curr != nullptr) {
+            if (matches(*curr, fullHash, key)) {
+                beforeErase(curr->payload);
+                releasePayload(curr->payload);
+                unsigned int link = prev->next;
+                prev->next = curr->next;
+                releaseNode(link);
+                count--;
+                return true;
+            }
+            prev = curr;
+            curr = follow(curr->next);
+        }
+        return false;
+    }
+
+    template <typename Lookup>
+    bool erase(const Lookup& key) {
+        return erase(key, [](unsigned int) {});
+    }
+
+    /**
+     * Look up a batch of keys at once.
+     *
+     * A single find stalls on every chain link it follows. Here the
+     * lookups are processed in groups of SEARCH_GROUP_SIZE:
+     *  - Hash every key of the group and prefetch its bucket head.
+     *  - Walk all the chains of the group interleaved, one hop per key per
+     *    round, prefetching the next node as soon as its link is known.
+     *  - With hashed nodes, when a node's hash matches, prefetch its entry
+     *    and compare the key on the next round instead of stalling on it.
+     * By the time a key is visited again its line has usually arrived, so
+     * the memory latency of one chain overlaps with the work on the others.
+     *
+     * @param keys the keys to look up
+     * @param results receives a pointer to each value, or nullptr when the
+     *                key is not stored; valid until the table is modified
+     */
+    template <typename Lookup>
+    void findBatch(std::span<const Lookup> keys, std::span<const V*> results) const {
+        if (results.size() < keys.size()) {
+            throw std::invalid_argument("findBatch: results is shorter than keys");
+        }
+
+        const Node *cursor[SEARCH_GROUP_SIZE];
+        std::size_t hashes[SEARCH_GROUP_SIZE];
+        bool comparing[SEARCH_GROUP_SIZE]; // hash matched, entry requested last round
+        for (std::size_t group_start = 0; group_start < keys.size(); group_start += SEARCH_GROUP_SIZE) {
+            std::size_t group_size = std::min(SEARCH_GROUP_SIZE, keys.size() - group_start);
+
+            // stage 1: hash the whole group and request every bucket head
+            for (std::size_t i = 0; i < group_size; ++i) {
+                hashes[i] = hasher(keys[group_start + i]);
+                cursor[i] = &nodes[bucketOf(hashes[i])];
+                comparing[i] = false;
+                prefetch(cursor[i]);
+            }
+
+            // stage 2: advance every unfinished lookup by one node per round
+            std::size_t pending = group_size;
+            while (pending > 0) {
+                for (std::size_t i = 0; i < group_size; ++i) {
+                    const Node *node = cursor[i];
+                    if (node == nullptr) {
+                        continue; // this lookup already finished
+                    }
+                    // empty heads (payload == EMPTY) never have a chain behind them
+                    bool found;
+                    if constexpr (INLINE_KEYS) {
+                        found = node->payload != EMPTY && equal(node->key, keys[group_start + i]);
+                    } else {
+                        if (!comparing[i] && node->payload != EMPTY && node->hash == hashes[i]) {
+                            comparing[i] = true;
+                            prefetch(&payloads[node->payload]);
+                            continue;
+                        }
+                        found = comparing[i] && equal(payloads[node->payload].key, keys[group_start + i]);
+                        comparing[i] = false;
+                    }
+                    if (found) {
+                        results[group_start + i] = &value(node->payload);
+                        cursor[i] = nullptr;
+                        pending--;
+                    } else if (node->next == NO_NODE) {
+                        results[group_start + i] = nullptr;
+                        cursor[i] = nullptr;
+                        pending--;
+                    } else {
+                        cursor[i] = &chainNodes[node->next];
+                        prefetch(cursor[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Load a whole batch of entries in one pass.
+     *
+     * Inserting one by one rescans a chain for duplicates on every call.
+     * Knowing the full batch up front allows instead:
+     *  - Size the table so the load factor is at most 1.
+     *  - Count the entries per bucket and partition them by bucket
+     *    (a radix-style counting pass, stable in batch order).
+     *  - Dedup inside each bucket; a later entry with the same key
+     *    replaces the earlier one, just like insert does.
+     *  - Store the surviving values densely, then lay every chain out
+     *    contiguously in the node pool.
+     * The hashing, dedup and layout passes are split across worker threads.
+     * Entries already in the table are kept and treated as older than the
+     * batch. Every value gets a new slot, numbered 0 .. size() - 1.
+     *
+     * @param entries the (key, value) pairs to load, oldest first
+     */
+    void bulkLoad(std::vector<std::pair<K, V>> entries) {
+        // existing entries go first so the batch wins on conflicts
+        if (count > 0) {
+            std::vector<std::pair<K, V>> all;
+            all.reserve(count + entries.size());
+            forEachNode([&](const Node& node) {
+                if constexpr (INLINE_KEYS) {
+                    all.emplace_back(node.key, std::move(payloads[node.payload]));
+                } else {
+                    all.emplace_back(std::move(payloads[node.payload].key), std::move(payloads[node.payload].value));
+                }
+            });
+            std::move(entries.begin(), entries.end(), std::back_inserter(all));
+            entries.swap(all);
+        }
+
+        // reset to an empty table with at least one bucket per entry
+        tableSize = std::max(tableSize, std::bit_ceil(static_cast<unsigned int>(entries.size())));
+        payloads.clear();
+        freePayloads.clear();
+        count = 0;
+
+        // hash pass (parallel): the key hashing is the expensive part
+        std::vector<std::size_t> hashes(entries.size());
+        parallelFor(entries.size(), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                hashes[i] = hasher(entries[i].first);
+            }
+        });
+
+        // count pass: bucket sizes, turned into bucket start offsets
+        std::vector<unsigned int> bucketStart(tableSize + 1, 0);
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            bucketStart[bucketOf(hashes[i]) + 1]++;
+        }
+        for (unsigned int bucket_index = 0; bucket_index < tableSize; ++bucket_index) {
+            bucketStart[bucket_index + 1] += bucketStart[bucket_index];
+        }
+
+        // partition pass: entry indexes grouped by bucket, batch order kept
+        std::vector<unsigned int> order(entries.size());
+        std::vector<unsigned int> fill(bucketStart.begin(), bucketStart.end() - 1);
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            order[fill[bucketOf(hashes[i])]++] = static_cast<unsigned int>(i);
+        }
+
+        // dedup pass (parallel over buckets): compact each bucket to its
+        // distinct keys, last write wins
+        std::vector<unsigned int> bucketSize(tableSize, 0);
+        parallelFor(tableSize, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t bucket_index = begin; bucket_index < end; ++bucket_index) {
+                unsigned int first = bucketStart[bucket_index];
+                unsigned int kept = 0;
+                for (unsigned int j = first; j < bucketStart[bucket_index + 1]; ++j) {
+                    unsigned int k = 0;
+                    while (k < kept && (hashes[order[first + k]] != hashes[order[j]] ||
+                                        !equal(entries[order[first + k]].first, entries[order[j]].first))) {
+                        k++;
+                    }
+                    if (k < kept) {
+                        entries[order[first + k]].second = std::move(entries[order[j]].second);
+                    } else {
+                        order[first + kept++] = order[j];
+                    }
+                }
+                bucketSize[bucket_index] = kept;
+            }
+        });
+
+        // the kept entries of each bucket get consecutive slots
+        std::vector<unsigned int> payloadStart(tableSize + 1, 0);
+        for (unsigned int bucket_index = 0; bucket_index < tableSize; ++bucket_index) {
+            payloadStart[bucket_index + 1] = payloadStart[bucket_index] + bucketSize[bucket_index];
+        }
+        count = payloadStart[tableSize];
+
+        // payload pass (parallel over buckets): move the kept values into place
+        payloads.resize(count);
+        std::vector<Node> linked(count);
+        std::vector<std::size_t> linkedHashes(count);
+        parallelFor(tableSize, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t bucket_index = begin; bucket_index < end; ++bucket_index) {
+                for (unsigned int k = 0; k < bucketSize[bucket_index]; ++k) {
+                    unsigned int payload = payloadStart[bucket_index] + k;
+                    unsigned int source = order[bucketStart[bucket_index] + k];
+                    setKey(linked[payload], hashes[source], entries[source].first);
+                    linked[payload].payload = payload;
+                    linkedHashes[payload] = hashes[source];
+                    if constexpr (INLINE_KEYS) {
+                        payloads[payload] = std::move(entries[source].second);
+                    } else {
+                        payloads[payload] = Entry{std::move(entries[source].first), std::move(entries[source].second)};
+                    }
+                }
+            }
+        });
+        linkBuckets(linked, linkedHashes);
+    }
+
+    // Visit the slot of every stored value in buckets [begin, end), in bucket order
+    template <typename Visitor>
+    void forEachSlotInBuckets(std::size_t begin, std::size_t end, Visitor visit) const {
+        for (std::size_t bucket_index = begin; bucket_index < end; ++bucket_index) {
+            for (const Node *iter = &nodes[bucket_index]; iter != nullptr; iter = follow(iter->next)) {
+                if (iter->payload != EMPTY) visit(iter->payload);
+            }
+        }
+    }
+
+    // Visit the slot of every stored value in bucket order
+    template <typename Visitor>
+    void forEachSlot(Visitor visit) const {
+        forEachSlotInBuckets(0, tableSize, visit);
+    }
+
+    // Visit every stored value in bucket order
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        forEachSlot([&](unsigned int slot) { visit(value(slot)); });
+    }
+
+    void clear() {
+        nodes.assign(tableSize, Node());
+        chainNodes.clear();
+        freeNodes = NO_NODE;
+        payloads.clear();
+        freePayloads.clear();
+        count = 0;
+    }
+
+private:
+    static V& valueOf(Payload& payload) {
+        if constexpr (INLINE_KEYS) return payload;
+        else return payload.value;
+    }
+
+    static const V& valueOf(const Payload& payload) {
+        if constexpr (INLINE_KEYS) return payload;
+        else return payload.value;
+    }
+
+    // bucket of a hash: its low bits, tableSize being a power of two
+    unsigned int bucketOf(std::size_t fullHash) const {
+        return static_cast<unsigned int>(fullHash & (tableSize - 1));
+    }
+
+    // node a next link points to, nullptr at the end of the chain
+    const Node *follow(unsigned int link) const {
+        return link == NO_NODE ? nullptr : &chainNodes[link];
+    }
+
+    Node *follow(unsigned int link) {
+        return link == NO_NODE ? nullptr : &chainNodes[link];
+    }
+
+    // the key, or only its hash, as the node layout keeps it
+    static void setKey(Node& node, std::size_t fullHash, const K& key) {
+        if constexpr (INLINE_KEYS) node.key = key;
+        else node.hash = fullHash;
+    }
+
+    std::size_t hashOf(const Node& node) const {
+        if constexpr (INLINE_KEYS) return hasher(node.key);
+        else return node.hash;
+    }
+
+    // a stored node holds key; hashed nodes only read the entry on a hash match
+    template <typename Lookup>
+    bool matches(const Node& node, std::size_t fullHash, const Lookup& key) const {
+        if constexpr (INLINE_KEYS) {
+            (void)fullHash;
+            return equal(node.key, key);
+        } else {
+            return node.hash == fullHash && equal(payloads[node.payload].key, key);
+        }
+    }
+
+    template <typename Visitor>
+    void forEachNode(Visitor visit) const {
+        for (unsigned int bucket_index = 0; bucket_index < tableSize; ++bucket_index) {
+            for (const Node *iter = &nodes[bucket_index]; iter != nullptr; iter = follow(iter->next)) {
+                if (iter->payload != EMPTY) visit(*iter);
+            }
+        }
+    }
+
+    /**
+     * Take a chain node from the free list, or from the end of the pool.
+     * Growing the pool may move it, so callers hold on to indexes, not
+     * Node pointers, across this call.
+     */
+    unsigned int allocateNode(std::size_t fullHash, const K& key, unsigned int payload) {
+        unsigned int link;
+        if (freeNodes != NO_NODE) {
+            link = freeNodes;
+            freeNodes = chainNodes[link].next;
+        } else {
+            chainNodes.emplace_back();
+            link = static_cast<unsigned int>(chainNodes.size() - 1);
+        }
+        Node& node = chainNodes[link];
+        setKey(node, fullHash, key);
+        node.payload = payload;
+        node.next = NO_NODE;
+        return link;
+    }
+
+    // return an unlinked chain node to the free list
+    void releaseNode(unsigned int link) {
+        chainNodes[link].payload = EMPTY;
+        chainNodes[link].next = freeNodes;
+        freeNodes = link;
+    }
+
+    // store V(args...) for a new key, reusing the slot of an erased value if any
+    template <typename... Args>
+    unsigned int allocatePayload(const K& key, Args&&... args) {
+        if (freePayloads.empty()) {
+            if constexpr (INLINE_KEYS) payloads.emplace_back(std::forward<Args>(args)...);
+            else payloads.emplace_back(key, std::forward<Args>(args)...);
+            return static_cast<unsigned int>(payloads.size() - 1);
+        }
+        unsigned int payload = freePayloads.back();
+        freePayloads.pop_back();
+        if constexpr (INLINE_KEYS) payloads[payload] = V(std::forward<Args>(args)...);
+        else payloads[payload] = Entry{key, V(std::forward<Args>(args)...)};
+        return payload;
+    }
+
+    void releasePayload(unsigned int payload) {
+        payloads[payload] = Payload(); // drop the value now rather than on reuse
+        freePayloads.push_back(payload);
+    }
+
+    /**
+     * Relink the buckets over a set of stored values with distinct keys.
+     *
+     * Count the nodes per bucket and partition them by bucket, then lay
+     * every chain out contiguously in the node pool. Only nodes are
+     * written; the values and their slots are left alone.
+     *
+     * @param linked one node (key or hash, and payload) per stored value
+     * @param hashes full hash of the key of each of them
+     */
+    void linkBuckets(const std::vector<Node>& linked, const std::vector<std::size_t>& hashes) {
+        nodes.assign(tableSize, Node());
+        freeNodes = NO_NODE;
+
+        // count pass: bucket sizes, turned into bucket start offsets
+        std::vector<unsigned int> bucketStart(tableSize + 1, 0);
+        for (std::size_t i = 0; i < linked.size(); ++i) {
+            bucketStart[bucketOf(hashes[i]) + 1]++;
+        }
+        for (unsigned int bucket_index = 0; bucket_index < tableSize; ++bucket_index) {
+            bucketStart[bucket_index + 1] += bucketStart[bucket_index];
+        }
+
+        // partition pass: nodes grouped by bucket
+        std::vector<unsigned int> order(linked.size());
+        std::vector<unsigned int> fill(bucketStart.begin(), bucketStart.end() - 1);
+        for (std::size_t i = 0; i < linked.size(); ++i) {
+            order[fill[bucketOf(hashes[i])]++] = static_cast<unsigned int>(i);
+        }
+
+        // every bucket past its head needs size - 1 chain nodes
+        std::vector<unsigned int> chainStart(tableSize + 1, 0);
+        for (unsigned int bucket_index = 0; bucket_index < tableSize; ++bucket_index) {
+            unsigned int size = bucketStart[bucket_index + 1] - bucketStart[bucket_index];
+            chainStart[bucket_index + 1] = chainStart[bucket_index] + (size > 1 ? size - 1 : 0);
+        }
+
+        // layout pass (parallel over buckets): heads in place, every chain
+        // contiguous in the pool
+        chainNodes.assign(chainStart[tableSize], Node());
+        parallelFor(tableSize, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t bucket_index = begin; bucket_index < end; ++bucket_index) {
+                unsigned int first = bucketStart[bucket_index];
+                Node *prev = &nodes[bucket_index];
+                for (unsigned int k = 0; k < bucketStart[bucket_index + 1] - first; ++k) {
+                    unsigned int link = chainStart[bucket_index] + k - 1;
+                    Node *node = (k == 0) ? prev : &chainNodes[link];
+                    *node = linked[order[first + k]];
+                    node->next = NO_NODE;
+                    if (k > 0) {
+                        prev->next = link;
+                        prev = node;
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * Redistribute every value over newSize buckets.
+     * The values keep their slots; only the nodes are rebuilt, from the
+     * keys or hashes they already hold, so no entry is read.
+     */
+    void rehash(unsigned int newSize) {
+        std::vector<Node> linked;
+        std::vector<std::size_t> hashes;
+        linked.reserve(count);
+        hashes.reserve(count);
+        forEachNode([&](const Node& node) {
+            linked.push_back(node);
+            hashes.push_back(hashOf(node));
+        });
+        tableSize = newSize;
+        linkBuckets(linked, hashes);
+    }
+
+    std::vector<Node, Rebind<Node>> nodes;      // one head per bucket
+    std::vector<Node, Rebind<Node>> chainNodes; // chained nodes, linked by index
+    std::vector<Payload, Rebind<Payload>> payloads;
+    std::vector<unsigned int, Rebind<unsigned int>> freePayloads;
+    unsigned int freeNodes = NO_NODE;
+    unsigned int tableSize;
+    unsigned int count = 0;
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEq equal;
+};
+
+#endif /*!_HASHTABLE_HPP_*/
@@ -0,0 +1,86 @@
+#ifndef     _SPSCRING_HPP_
+# define    _SPSCRING_HPP_
+
+# include <atomic>
+# include <cstddef>
+# include <utility>
+# include <vector>
+
+/**
+ * Bounded single-producer / single-consumer ring buffer.
+ *
+ * Exactly one thread may push and exactly one thread may pop. The two
+ * indices live on separate cache lines so producer and consumer never
+ * false-share, and no mutex is taken on either side: a full or empty
+ * ring parks the caller with std::atomic::wait (a futex on Linux)
+ * instead of spinning.
+ */
+template <typename T>
+class SpscRing
+{
+    public:
+        explicit SpscRing(std::size_t capacity)
+        {
+            std::size_t size = 1;
+            while (size < capacity)
+                size <<= 1;
+            _slots.resize(size);
+            _mask = size - 1;
+        }
+
+        SpscRing(const SpscRing &) = delete;
+        SpscRing &operator=(const SpscRing &) = delete;
+
+    public:
+        bool tryPush(T &value)
+        {
+            std::size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail - _head.load(std::memory_order_acquire) == _slots.size())
+                return false;
+            _slots[tail & _mask] = std::move(value);
+            _tail.store(tail + 1, std::memory_order_release);
+            _tail.notify_one();
+            return true;
+        }
+
+        // blocks while the ring is full
+        void push(T value)
+        {
+            while (!tryPush(value))
+            {
+                std::size_t head = _head.load(std::memory_order_acquire);
+                if (_tail.load(std::memory_order_relaxed) - head == _slots.size())
+                    _head.wait(head, std::memory_order_acquire);
+            }
+        }
+
+        bool tryPop(T &out)
+        {
+            std::size_t head = _head.load(std::memory_order_relaxed);
+            if (head == _tail.load(std::memory_order_acquire))
+                return false;
+            out = std::move(_slots[head & _mask]);
+            _head.store(head + 1, std::memory_order_release);
+            _head.notify_one();
+            return true;
+        }
+
+        // blocks while the ring is empty
+        void pop(T &out)
+        {
+            while (!tryPop(out))
+            {
+                std::size_t tail = _tail.load(std::memory_order_acquire);
+                if (_head.load(std::memory_order_relaxed) == tail)
+                    _tail.wait(tail, std::memory_order_acquire);
+            }
+        }
+
+    private:
+        alignas(64) std::atomic<std::size_t> _head{0}; // next slot to pop
+        alignas(64) std::atomic<std::size_t> _tail{0}; // next slot to push
+        alignas(64) std::vector<T> _slots;
+        std::size_t _mask;
+};
+
+#endif /*!_SPSCRING_HPP_*/
@@ -0,0 +1,196 @@
+/*
+** Checks of the CSV layer, run by ctest (or make test). Each check
+** prints its name and ok or FAIL; the exit status is the number of
+** failed checks.
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#ifdef CSV_HAVE_ZLIB
+# include <zlib.h>
+#endif
+#include "CSVparser.hpp"
+#include "CSVreader.hpp"
+
+namespace
+{
+  int failures = 0;
+
+  void check(bool passed, const std::string &what)
+  {
+      std::cout << (passed ? "ok    " : "FAIL  ") << what << std::endl;
+      if (!passed)
+        failures++;
+  }
+
+  // every record of text (comments and blank lines dropped) as its fields
+  std::vector<std::vector<std::string> > parsed(const std::string &text, const csv::Dialect &dialect,
+                                                csv::LoadMode mode)
+  {
+      csv::Parser file(text, csv::ePURE, dialect, mode);
+      std::vector<std::vector<std::string> > rows;
+      for (unsigned int i = 0; i < file.rowCount(); i++)
+      {
+        std::vector<std::string> &row = rows.emplace_back();
+        for (unsigned int column = 0; column < file.columnCount(); column++)
+          row.emplace_back(file[i][column]);
+      }
+      return rows;
+  }
+
+  // a quote on a comment line must not run on into the records after it
+  void commentsWithQuotes(void)
+  {
+      const std::string text = "# don't \"quote this\nk,v\n1,a\n# another \" one\n2,\"b\nc\"\n";
+      const std::vector<std::vector<std::string> > expected = {{"1", "a"}, {"2", "b\nc"}};
+
+      csv::Dialect doubled;
+      doubled.comment = '#';
+      csv::Dialect escaped = doubled;
+      escaped.escape = '\\';
+
+      csv::RecordState state;
+      const char *newline = csv::findRecordEnd(text.data(), text.size(), state, doubled);
+      check(newline == text.data() + text.find('\n'), "findRecordEnd stops at the end of a comment");
+
+      check(parsed(text, doubled, csv::eEAGER) == expected, "comment with a quote, eager");
+      check(parsed(text, doubled, csv::eLAZY) == expected, "comment with a quote, lazy");
+      check(parsed(text, escaped, csv::eEAGER) == expected, "comment with a quote, escape dialect");
+
+      // the same text read a few bytes at a time, so comments are cut across blocks
+      std::string path = "CSVparserTest.csv";
+      {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << text;
+      }
+      std::vector<std::vector<std::string> > streamed;
+      {
+        csv::StreamParser stream(path, 3, doubled);
+        csv::RowBatch rows;
+        while (stream.nextBatch(rows))
+          streamed.insert(streamed.end(), rows.begin(), rows.end());
+      }
+      std::remove(path.c_str());
+      check(streamed == expected, "comment with a quote, streamed in 3-byte blocks");
+  }
+
+#ifdef CSV_HAVE_ZLIB
+  // one gzip member: a BGZF block (with isize as its ISIZE trailer) or a plain member
+  std::string gzipMember(const std::string &data, bool bgzf, uint32_t isize)
+  {
+      std::string body(compressBound(data.size()) + 16, '\0');
+      z_stream zs = z_stream();
+      deflateInit2(&zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+      zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+      zs.avail_in = static_cast<uInt>(data.size());
+      zs.next_out = reinterpret_cast<Bytef *>(&body[0]);
+      zs.avail_out = static_cast<uInt>(body.size());
+      deflate(&zs, Z_FINISH);
+      body.resize(zs.total_out);
+      deflateEnd(&zs);
+
+      std::string member("\x1f\x8b\x08", 3);
+      member += bgzf ? '\x04' : '\0';
+      member.append(4, '\0');
+      member += '\0';
+      member += '\xff';
+      if (bgzf)
+      {
+        size_t blockSize = body.size() + 25;
+        const char extra[] = {6, 0, 'B', 'C', 2, 0, static_cast<char>(blockSize & 0xff),
+                              static_cast<char>(blockSize >> 8)};
+        member.append(extra, sizeof(extra));
+      }
+      member += body;
+      uint32_t trailer[2] = {static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef *>(data.data()),
+                                                         static_cast<uInt>(data.size()))), isize};
+      member.append(reinterpret_cast<const char *>(trailer), sizeof(trailer));
+      return member;
+  }
+
+  std::string decoded(const std::string &path)
+  {
+      csv::BlockReader reader(path, 1 << 16);
+      std::string text;
+      const char *block;
+      size_t length;
+      while (reader.next(block, length))
+        text.append(block, length);
+      return text;
+  }
+
+  // BGZF is decoded block by block in parallel; what is not BGZF goes to the streaming decoder
+  void gzipFallback(void)
+  {
+      std::string text = "k,v\n";
+      for (int i = 0; i < 20000; i++)
+        text += std::to_string(i) + ",value" + std::to_string(i) + "\n";
+      std::vector<std::string> chunks;
+      for (size_t i = 0; i < text.size(); i += 60000)
+        chunks.push_back(text.substr(i, 60000));
+      std::string path = "CSVparserTest.csv.gz";
+
+      // BGZF blocks, then the rest as one plain gzip member
+      {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << gzipMember(chunks[0], true, chunks[0].size());
+        std::string rest = text.substr(chunks[0].size());
+        out << gzipMember(rest, false, rest.size());
+      }
+      check(decoded(path) == text, "BGZF followed by a plain gzip member");
+
+      // a BGZF block claiming to hold 4 GiB is not trusted with an allocation
+      {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << gzipMember(chunks[0], true, chunks[0].size());
+        out << gzipMember(chunks[1], true, 0xfffffff0u);
+      }
+      bool rejected = false;
+      try
+      {
+        decoded(path);
+      }
+      catch (const csv::Error &)
+      {
+        rejected = true;
+      }
+      check(rejected, "BGZF block with an oversized ISIZE is reported as corrupt");
+
+      // sync cannot write a compressed file back, and leaves it as it was
+      std::string compressed = gzipMember(text, false, text.size());
+      {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << compressed;
+      }
+      bool refused = false;
+      try
+      {
+        csv::Parser file(path);
+        file.deleteRow(0);
+        file.sync();
+      }
+      catch (const csv::Error &)
+      {
+        refused = true;
+      }
+      std::ifstream in(path, std::ios::binary);
+      std::string kept((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+      check(refused && kept == compressed, "sync refuses a compressed file");
+      std::remove(path.c_str());
+  }
+#endif
+}
+
+int main(void)
+{
+    commentsWithQuotes();
+#ifdef CSV_HAVE_ZLIB
+    gzipFallback();
+#endif
+    return failures;
+}